@@ -0,0 +1,190 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+#include "../trace.h"
+
+
+using IntensityType = float;
+using SumType = double;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int STRIP_SIZE = 1024;  // row elements per thread in the column pass
+const int RADIUS = 8;
+const float SIGMA = 5.0f;
+const int N_GAUSS_PASSES = 3;
+
+
+// Summed-area table with a leading zero row and column:
+// sum[((i+1)*(width+1) + (j+1))*N_CHANNELS + k] is the sum over [0..i] x [0..j].
+__declspec(noinline) void integral(int height, int width,
+	const IntensityType* pixels, SumType* sum)
+{
+	TRACE_SCOPE("integral");
+	const int rowSize = width * N_CHANNELS, stride = (width + 1) * N_CHANNELS;
+
+	#pragma omp simd
+	for (int e = 0; e < stride; e++)
+		sum[e] = 0;
+
+	#pragma omp parallel for
+	for (int i = 0; i < height; i++) {
+		const IntensityType* src = pixels + i * rowSize;
+		SumType* row = sum + (i + 1) * stride;
+		SumType rowSum[N_CHANNELS] = {};
+		for (int k = 0; k < N_CHANNELS; k++)
+			row[k] = 0;
+		for (int j = 0; j < width; j++)
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++) {
+				rowSum[k] += src[j * N_CHANNELS + k];
+				row[(j + 1) * N_CHANNELS + k] = rowSum[k];
+			}
+	}
+
+	const int nStrips = (stride + STRIP_SIZE - 1) / STRIP_SIZE;
+	#pragma omp parallel for
+	for (int s = 0; s < nStrips; s++) {
+		TRACE_SCOPE("integral strip");
+		const int begin = s * STRIP_SIZE;
+		const int size = std::min(STRIP_SIZE, stride - begin);
+		for (int i = 1; i < height; i++) {
+			const SumType* prev = sum + i * stride + begin;
+			SumType* row = sum + (i + 1) * stride + begin;
+			#pragma omp simd
+			for (int e = 0; e < size; e++)
+				row[e] += prev[e];
+		}
+	}
+}
+
+// Window [i - radius, i + radius] x [j - radius, j + radius] clipped to the image.
+// BY_COUNT divides by the pixels actually covered (mean filter), otherwise by the
+// full window area, i.e. the image is padded with zeros (box filter).
+template <bool BY_COUNT>
+void boxAverage(int height, int width, int radius,
+	const SumType* sum, IntensityType* result)
+{
+	TRACE_SCOPE("boxAverage");
+	const int stride = (width + 1) * N_CHANNELS;
+	const SumType invFullArea = (SumType)1 / ((2 * radius + 1) * (2 * radius + 1));
+
+	#pragma omp parallel for
+	for (int i = 0; i < height; i++) {
+		const int i0 = std::max(i - radius, 0), i1 = std::min(i + radius, height - 1) + 1;
+		const SumType* top = sum + i0 * stride, * bottom = sum + i1 * stride;
+
+		#pragma omp simd
+		for (int j = 0; j < width; j++) {
+			const int j0 = std::max(j - radius, 0), j1 = std::min(j + radius, width - 1) + 1;
+			const SumType invArea = BY_COUNT ? (SumType)1 / ((i1 - i0) * (j1 - j0)) : invFullArea;
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++) {
+				const int a = j0 * N_CHANNELS + k, b = j1 * N_CHANNELS + k;
+				result[(i * width + j) * N_CHANNELS + k] =
+					(IntensityType)((bottom[b] - bottom[a] - top[b] + top[a]) * invArea);
+			}
+		}
+	}
+}
+
+__declspec(noinline) void boxFilter(int height, int width, int radius,
+	const IntensityType* pixels, IntensityType* result)
+{
+	TRACE_SCOPE("boxFilter");
+	std::vector<SumType> sum((height + 1) * (width + 1) * N_CHANNELS);
+	integral(height, width, pixels, sum.data());
+	boxAverage<false>(height, width, radius, sum.data(), result);
+}
+
+__declspec(noinline) void meanFilter(int height, int width, int radius,
+	const IntensityType* pixels, IntensityType* result)
+{
+	TRACE_SCOPE("meanFilter");
+	std::vector<SumType> sum((height + 1) * (width + 1) * N_CHANNELS);
+	integral(height, width, pixels, sum.data());
+	boxAverage<true>(height, width, radius, sum.data(), result);
+}
+
+// Box radii whose n-fold convolution has the variance of a Gaussian with this sigma:
+// the first m passes use width wl, the rest wl + 2 (both odd).
+std::vector<int> gaussBoxRadii(float sigma, int n)
+{
+	const float wIdeal = std::sqrt(12 * sigma * sigma / n + 1);
+	int wl = (int)std::floor(wIdeal);
+	if (wl % 2 == 0) wl--;
+	const int wu = wl + 2;
+	const int m = (int)std::round((12 * sigma * sigma - n * wl * wl - 4 * n * wl - 3 * n) / (-4 * wl - 4));
+
+	std::vector<int> radii(n);
+	for (int pass = 0; pass < n; pass++)
+		radii[pass] = ((pass < m ? wl : wu) - 1) / 2;
+	return radii;
+}
+
+// approximate Gaussian blur as iterated mean filters, the cost does not depend on sigma
+__declspec(noinline) void gaussianBlur(int height, int width, float sigma,
+	const IntensityType* pixels, IntensityType* result)
+{
+	TRACE_SCOPE("gaussianBlur");
+	std::vector<SumType> sum((height + 1) * (width + 1) * N_CHANNELS);
+	std::vector<IntensityType> tmp(pixels, pixels + height * width * N_CHANNELS);
+
+	for (int radius : gaussBoxRadii(sigma, N_GAUSS_PASSES)) {
+		integral(height, width, tmp.data(), sum.data());
+		boxAverage<true>(height, width, radius, sum.data(), tmp.data());
+	}
+	std::copy(tmp.begin(), tmp.end(), result);
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	std::vector<IntensityType> pixels;
+	{
+		TRACE_SCOPE("load");
+		if (!reader.open("photo.bmp")) {
+			std::cout << "Error when reading" << std::endl;
+			return 0;
+		}
+		pixels = reader.getRGBPixels<IntensityType>();
+	}
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	std::vector<IntensityType> boxPixels(pixels.size()), meanPixels(pixels.size()), gaussPixels(pixels.size());
+
+	auto t0 = std::chrono::steady_clock::now();
+	boxFilter(height, width, RADIUS, pixels.data(), boxPixels.data());
+	auto t1 = std::chrono::steady_clock::now();
+	meanFilter(height, width, RADIUS, pixels.data(), meanPixels.data());
+	auto t2 = std::chrono::steady_clock::now();
+	gaussianBlur(height, width, SIGMA, pixels.data(), gaussPixels.data());
+	auto t3 = std::chrono::steady_clock::now();
+
+	std::cout << "Box filter time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()/1e6 << " sec" << std::endl;
+	std::cout << "Mean filter time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()/1e6 << " sec" << std::endl;
+	std::cout << "Gaussian blur time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "boxFilter", { std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1e6 });
+	saveResult(argv[0], "meanFilter", { std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1e6 });
+	saveResult(argv[0], "gaussianBlur", { std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1e6 });
+
+	{
+		TRACE_SCOPE("save");
+		reader.saveRGB(std::string(argv[0]) + "_box.bmp", boxPixels);
+		reader.saveRGB(std::string(argv[0]) + "_mean.bmp", meanPixels);
+		reader.saveRGB(std::string(argv[0]) + "_gauss.bmp", gaussPixels);
+	}
+	TRACE_SAVE(std::string(argv[0]) + "_trace.json");
+
+	return 0;
+}
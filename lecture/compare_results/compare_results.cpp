@@ -0,0 +1,248 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+
+const double ALPHA = 0.05;  // significance level of the test
+const double MIN_CHANGE = 0.02;  // smaller changes of the median are not reported
+const int EXACT_LIMIT = 50;  // exact test up to this many samples per build
+
+
+struct Record {
+	std::string benchmark, kernel, build, git, cpu;
+	std::vector<double> samples;
+};
+
+
+// the value of "key": "..." in a line written by saveResult
+std::string getString(const std::string& line, const std::string& key)
+{
+	size_t pos = line.find("\"" + key + "\": \"");
+	if (pos == std::string::npos)
+		return "";
+	std::string value;
+	for (pos += key.size() + 5; pos < line.size() && line[pos] != '"'; pos++) {
+		if (line[pos] == '\\')
+			pos++;
+		value += line[pos];
+	}
+	return value;
+}
+
+std::vector<double> getNumbers(const std::string& line, const std::string& key)
+{
+	std::vector<double> numbers;
+	size_t pos = line.find("\"" + key + "\": [");
+	if (pos == std::string::npos)
+		return numbers;
+	const char* p = line.c_str() + pos + key.size() + 5;
+	while (*p && *p != ']') {
+		char* end;
+		const double number = std::strtod(p, &end);
+		if (end == p)
+			break;
+		numbers.push_back(number);
+		p = end;
+		while (*p == ',' || *p == ' ')
+			p++;
+	}
+	return numbers;
+}
+
+std::vector<Record> readRecords(const std::string& fileName)
+{
+	std::vector<Record> records;
+	std::ifstream file(fileName);
+	std::string line;
+	while (std::getline(file, line)) {
+		Record record;
+		record.benchmark = getString(line, "benchmark");
+		record.kernel = getString(line, "kernel");
+		record.git = getString(line, "git");
+		record.cpu = getString(line, "cpu");
+		record.build = record.git + ", " + getString(line, "compiler") + ", " + getString(line, "flags") +
+			", " + getString(line, "build_id");
+		record.samples = getNumbers(line, "samples");
+		if (!record.benchmark.empty() && !record.samples.empty())
+			records.push_back(record);
+	}
+	return records;
+}
+
+
+double median(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	const size_t n = values.size();
+	return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// Two-sided p-value of the Mann-Whitney U test: how likely samples this far apart
+// are if both builds have the same distribution of times. It only uses the ranks,
+// so a few outliers (an interrupt, a frequency change) do not decide it.
+double mannWhitneyP(const std::vector<double>& x, const std::vector<double>& y)
+{
+	const int n1 = x.size(), n2 = y.size(), n = n1 + n2;
+	std::vector<std::pair<double, int>> all;
+	for (double value : x)
+		all.push_back({ value, 0 });
+	for (double value : y)
+		all.push_back({ value, 1 });
+	std::sort(all.begin(), all.end());
+
+	// average ranks for ties
+	double rankSumX = 0.0, tieTerm = 0.0;
+	for (int i = 0; i < n; ) {
+		int j = i;
+		while (j < n && all[j].first == all[i].first)
+			j++;
+		const double rank = (i + 1 + j) / 2.0;
+		for (int k = i; k < j; k++)
+			if (all[k].second == 0)
+				rankSumX += rank;
+		const double t = j - i;
+		tieTerm += t * t * t - t;
+		i = j;
+	}
+	const double u = rankSumX - n1 * (n1 + 1) / 2.0;
+
+	if (tieTerm == 0.0 && n1 <= EXACT_LIMIT && n2 <= EXACT_LIMIT) {
+		// count[a][b][v]: orderings of a x's and b y's with U = v; the largest
+		// element is either an x above all b y's or a y
+		std::vector<std::vector<std::vector<double>>> count(n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+		for (int a = 0; a <= n1; a++)
+			for (int b = 0; b <= n2; b++) {
+				count[a][b].assign(a * b + 1, 0.0);
+				if (a == 0 || b == 0) {
+					count[a][b][0] = 1.0;
+					continue;
+				}
+				for (int v = 0; v <= a * b; v++)
+					count[a][b][v] = (v >= b ? count[a - 1][b][v - b] : 0.0) +
+						(v <= a * (b - 1) ? count[a][b - 1][v] : 0.0);
+			}
+		double total = 0.0, below = 0.0, above = 0.0;
+		for (int v = 0; v <= n1 * n2; v++) {
+			total += count[n1][n2][v];
+			if (v <= u) below += count[n1][n2][v];
+			if (v >= u) above += count[n1][n2][v];
+		}
+		return std::min(1.0, 2.0 * std::min(below, above) / total);
+	}
+
+	const double mean = n1 * n2 / 2.0;
+	const double sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1.0))));
+	if (sigma == 0.0)
+		return 1.0;
+	const double z = std::max(0.0, std::fabs(u - mean) - 0.5) / sigma;  // with continuity correction
+	return std::erfc(z / std::sqrt(2.0));
+}
+
+
+// the last build in the records that is the given one or was built from the
+// given git hash, "" if there is none
+std::string findBuild(const std::vector<Record>& records, const std::string& build)
+{
+	for (auto record = records.rbegin(); record != records.rend(); record++)
+		if (record->build == build || record->git == build)
+			return record->build;
+	return "";
+}
+
+// the CPU the build was run on, the last one if there are several
+std::string findCpu(const std::vector<Record>& records, const std::string& build)
+{
+	for (auto record = records.rbegin(); record != records.rend(); record++)
+		if (record->build == build)
+			return record->cpu;
+	return "";
+}
+
+
+// compare_results [results.jsonl] [baseline build] [new build]
+// A build is the git hash, the compiler, the flags and the build id, so two
+// builds of different uncommitted edits are not merged. A build on the command
+// line is either the whole description or the full git hash, which then means
+// its last build. Without them the last build in the file is compared with the
+// one before it on the same CPU. Returns 1 if some kernel got slower.
+int main(int argc, char** argv) {
+
+	const std::string fileName = argc > 1 ? argv[1] : "results.jsonl";
+	std::vector<Record> records = readRecords(fileName);
+	if (records.empty()) {
+		std::cout << "No results in " << fileName << std::endl;
+		return 0;
+	}
+
+	std::string baseBuild, newBuild = records.back().build;
+	if (argc > 3 && (newBuild = findBuild(records, argv[3])).empty()) {
+		std::cout << "No build " << argv[3] << " in " << fileName << std::endl;
+		return 0;
+	}
+	if (argc > 2 && (baseBuild = findBuild(records, argv[2])).empty()) {
+		std::cout << "No build " << argv[2] << " in " << fileName << std::endl;
+		return 0;
+	}
+	const std::string newCpu = findCpu(records, newBuild);
+	if (baseBuild.empty())
+		for (auto record = records.rbegin(); record != records.rend(); record++)
+			if (record->build != newBuild && record->cpu == newCpu) {
+				baseBuild = record->build;
+				break;
+			}
+	if (baseBuild.empty() || baseBuild == newBuild) {
+		std::cout << "Only one build (" << newBuild << ") on " << newCpu << " in " << fileName << std::endl;
+		return 0;
+	}
+	std::cout << "Baseline " << baseBuild << std::endl << "New      " << newBuild << std::endl;
+	const std::string baseCpu = findCpu(records, baseBuild);
+	if (baseCpu != newCpu)
+		std::cout << "WARNING: the builds ran on different CPUs, " << baseCpu << " and " << newCpu << std::endl;
+
+	// samples of every benchmark and kernel, for both builds
+	std::map<std::pair<std::string, std::string>, std::vector<double>> baseSamples, newSamples;
+	for (const Record& record : records) {
+		const auto key = std::make_pair(record.benchmark, record.kernel);
+		if (record.build == baseBuild)
+			baseSamples[key].insert(baseSamples[key].end(), record.samples.begin(), record.samples.end());
+		else if (record.build == newBuild)
+			newSamples[key].insert(newSamples[key].end(), record.samples.begin(), record.samples.end());
+	}
+
+	std::cout << std::setw(28) << "Benchmark" << std::setw(22) << "Kernel" << std::setw(12) << "Base, s" <<
+		std::setw(12) << "New, s" << std::setw(9) << "Change" << std::setw(9) << "p" << "  Verdict" << std::endl;
+	int nSlower = 0;
+	for (const auto& base : baseSamples) {
+		const auto found = newSamples.find(base.first);
+		if (found == newSamples.end())
+			continue;
+		const double baseMedian = median(base.second), newMedian = median(found->second);
+		const double change = newMedian / baseMedian - 1.0;
+		const double p = mannWhitneyP(base.second, found->second);
+
+		std::string verdict = "same";
+		if (base.second.size() < 2 || found->second.size() < 2)
+			verdict = "too few samples";
+		else if (p < ALPHA && change > MIN_CHANGE) {
+			verdict = "SLOWER";
+			nSlower++;
+		}
+		else if (p < ALPHA && change < -MIN_CHANGE)
+			verdict = "faster";
+
+		std::cout << std::setw(28) << base.first.first << std::setw(22) << base.first.second <<
+			std::setw(12) << std::setprecision(4) << baseMedian << std::setw(12) << newMedian <<
+			std::setw(8) << std::fixed << std::setprecision(1) << change * 100 << "%" <<
+			std::setw(9) << std::setprecision(3) << p << "  " << verdict << std::endl;
+		std::cout.unsetf(std::ios::fixed);
+	}
+	std::cout << nSlower << " slower" << std::endl;
+
+	return nSlower > 0 ? 1 : 0;
+}
@@ -5,6 +5,7 @@
 #include <chrono>
 
 #include "bmp_reader.h"
+#include "../result_store.h"
 
 
 using IntensityType = uint8_t;  // 1 byte
@@ -52,6 +53,7 @@ int main(int argc, char** argv) {
 	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 	
 	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "nonlinearCorrection", { time / 1e6 });
 	reader.setRGBPixels(resPixels);
 	
 	reader.save(std::string(argv[0]) + "_result.bmp");
@@ -6,6 +6,7 @@
 #include <windows.h>
 
 #include "bmp_reader.h"
+#include "../result_store.h"
 
 
 using IntensityType = float;
@@ -55,6 +56,7 @@ int main(int argc, char** argv) {
 	auto t1 = std::chrono::steady_clock::now();
 	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "nonlinearCorrection", { time / 1e6 });
 	
 	for (int i = 0; i < pixels.size(); i++)
 		resPixels[i] = resPixels_[i];
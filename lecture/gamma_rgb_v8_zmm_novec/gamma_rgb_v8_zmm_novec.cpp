@@ -5,6 +5,8 @@
 #include <chrono>
 
 #include "bmp_reader.h"
+#include "../result_store.h"
+#include "../trace.h"
 
 
 using IntensityType = float;
@@ -24,6 +26,7 @@ float correctPixelIntensity(float x)
 __declspec(noinline) void nonlinearCorrection(int height, int width,
 	IntensityType* pixels, IntensityType* result)
 {
+	TRACE_SCOPE("nonlinearCorrection");
 	#pragma novector
 	for (int i = 0; i < height * width * N_CHANNELS; i++) {
 		result[i] = correctPixelIntensity(pixels[i]);
@@ -34,12 +37,15 @@ __declspec(noinline) void nonlinearCorrection(int height, int width,
 int main(int argc, char** argv) {
 
 	BMPReader reader;
-	if (!reader.open("photo.bmp")) {
-		std::cout << "Error when reading" << std::endl;
-		return 0;
+	std::vector<IntensityType> pixels;
+	{
+		TRACE_SCOPE("load");
+		if (!reader.open("photo.bmp")) {
+			std::cout << "Error when reading" << std::endl;
+			return 0;
+		}
+		pixels = reader.getRGBPixels<IntensityType>();
 	}
-
-	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
 	const int height = reader.getHeight(), width = reader.getWidth();
 
 	std::vector<IntensityType> resPixels(pixels.size());
@@ -50,9 +56,13 @@ int main(int argc, char** argv) {
 	   float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 	
 	   std::cout << "Time is " << time/1e6 << " sec" << std::endl;
-	reader.setRGBPixels(resPixels);
-	
-	reader.save(std::string(argv[0]) + "_result.bmp");
+	   saveResult(argv[0], "nonlinearCorrection", { time / 1e6 });
+	{
+		TRACE_SCOPE("save");
+		reader.setRGBPixels(resPixels);
+		reader.save(std::string(argv[0]) + "_result.bmp");
+	}
+	TRACE_SAVE(std::string(argv[0]) + "_trace.json");
 		
 	return 0;
 }
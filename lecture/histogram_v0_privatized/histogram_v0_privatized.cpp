@@ -0,0 +1,128 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+#include <cstdint>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = uint8_t;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int N_BINS = 256;
+// Neighbouring pixels often have the same value, so one table would make every
+// increment wait for the previous store to the same counter. Pixel j goes to
+// sub-histogram j % N_SUB instead. Each thread has its own N_SUB tables (12 KB, in L1).
+const int N_SUB = 4;
+
+
+struct Rect {
+	int y, x;  // top-left corner
+	int height, width;
+};
+
+
+// reference: one shared table, one thread
+__declspec(noinline) void histogramNaive(int height, int width,
+	const IntensityType* pixels, const Rect& roi, uint64_t* bins)
+{
+	std::fill(bins, bins + N_CHANNELS * N_BINS, 0);
+	for (int i = roi.y; i < roi.y + roi.height; i++)
+		for (int j = roi.x; j < roi.x + roi.width; j++)
+			for (int k = 0; k < N_CHANNELS; k++)
+				bins[k * N_BINS + pixels[(i * width + j) * N_CHANNELS + k]]++;
+}
+
+// bins[k * N_BINS + v] is the number of pixels of roi with value v in channel k
+__declspec(noinline) void histogram(int height, int width,
+	const IntensityType* pixels, const Rect& roi, uint64_t* bins)
+{
+	std::fill(bins, bins + N_CHANNELS * N_BINS, 0);
+
+	#pragma omp parallel
+	{
+		// 32-bit counters: a counter sees at most (rows of the thread) * ceil(roi.width / N_SUB)
+		// pixels (the tail of a row goes round-robin as the body), < 2^32 as a bmp is < 4 GB
+		alignas(64) uint32_t sub[N_SUB][N_CHANNELS][N_BINS] = {};
+
+		#pragma omp for schedule(static)
+		for (int i = roi.y; i < roi.y + roi.height; i++) {
+			const IntensityType* row = pixels + (i * width + roi.x) * N_CHANNELS;
+			const int nBody = roi.width / N_SUB * N_SUB;
+
+			for (int j = 0; j < nBody; j += N_SUB)
+				#pragma unroll
+				for (int s = 0; s < N_SUB; s++) {
+					const IntensityType* p = row + (j + s) * N_CHANNELS;
+					sub[s][0][p[0]]++;
+					sub[s][1][p[1]]++;
+					sub[s][2][p[2]]++;
+				}
+			for (int j = nBody; j < roi.width; j++)
+				for (int k = 0; k < N_CHANNELS; k++)
+					sub[j % N_SUB][k][row[j * N_CHANNELS + k]]++;
+		}
+
+		uint64_t local[N_CHANNELS * N_BINS];
+		for (int k = 0; k < N_CHANNELS; k++)
+			#pragma omp simd
+			for (int v = 0; v < N_BINS; v++) {
+				uint64_t count = 0;
+				for (int s = 0; s < N_SUB; s++)
+					count += sub[s][k][v];
+				local[k * N_BINS + v] = count;
+			}
+
+		#pragma omp critical
+		{
+			#pragma omp simd
+			for (int b = 0; b < N_CHANNELS * N_BINS; b++)
+				bins[b] += local[b];
+		}
+	}
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	const Rect rois[] = {
+		{ 0, 0, height, width },  // whole image
+		{ height / 4, width / 4, height / 2, width / 2 }  // central part
+	};
+	std::vector<uint64_t> bins(N_CHANNELS * N_BINS), reference(N_CHANNELS * N_BINS);
+
+	for (const Rect& roi : rois) {
+		auto t0 = std::chrono::steady_clock::now();
+		histogramNaive(height, width, pixels.data(), roi, reference.data());
+		auto t1 = std::chrono::steady_clock::now();
+		histogram(height, width, pixels.data(), roi, bins.data());
+		auto t2 = std::chrono::steady_clock::now();
+		float timeNaive = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+		float time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+
+		std::cout << "ROI " << roi.width << "x" << roi.height << " at (" << roi.x << ", " << roi.y << ")" << std::endl;
+		std::cout << "Naive time is " << timeNaive/1e6 << " sec" << std::endl;
+		std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+		const std::string roiName = std::to_string(roi.width) + "x" + std::to_string(roi.height);
+		saveResult(argv[0], "histogramNaive " + roiName, { timeNaive / 1e6 });
+		saveResult(argv[0], "histogram " + roiName, { time / 1e6 });
+		if (bins != reference)
+			std::cout << "ERROR: WRONG RESULT!!!" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+using SumType = double;  // integer-valued sums stay exact up to 2^53
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int RADIUS = 2;  // local window is (2*RADIUS+1) x (2*RADIUS+1)
+
+// Tables have one zero row and one zero column in front:
+// sum[((i+1)*(width+1) + (j+1))*N_CHANNELS + k] is the sum over [0..i] x [0..j] of channel k,
+// so any box sum is four loads without boundary checks.
+template <bool WITH_SQUARES>
+void buildTables(int height, int width, const IntensityType* pixels,
+	SumType* sum, SumType* sqSum)
+{
+	const int stride = (width + 1) * N_CHANNELS;
+
+	for (int j = 0; j < stride; j++) {
+		sum[j] = 0;
+		if (WITH_SQUARES) sqSum[j] = 0;
+	}
+
+	for (int i = 0; i < height; i++) {
+		const IntensityType* row = pixels + i * width * N_CHANNELS;
+		const SumType* prev = sum + i * stride;
+		const SumType* prevSq = sqSum + i * stride;
+		SumType* cur = sum + (i + 1) * stride;
+		SumType* curSq = sqSum + (i + 1) * stride;
+
+		SumType rowSum[N_CHANNELS] = {}, rowSqSum[N_CHANNELS] = {};
+		for (int k = 0; k < N_CHANNELS; k++) {
+			cur[k] = 0;
+			if (WITH_SQUARES) curSq[k] = 0;
+		}
+
+		// one traversal of the row feeds both tables
+		for (int j = 0; j < width; j++)
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++) {
+				const int index = (j + 1) * N_CHANNELS + k;
+				const SumType x = row[j * N_CHANNELS + k];
+				rowSum[k] += x;
+				cur[index] = prev[index] + rowSum[k];
+				if (WITH_SQUARES) {
+					rowSqSum[k] += x * x;
+					curSq[index] = prevSq[index] + rowSqSum[k];
+				}
+			}
+	}
+}
+
+// sqSum may be nullptr if only the sum table is needed
+__declspec(noinline) void integral(int height, int width,
+	const IntensityType* pixels, SumType* sum, SumType* sqSum)
+{
+	if (sqSum)
+		buildTables<true>(height, width, pixels, sum, sqSum);
+	else
+		buildTables<false>(height, width, pixels, sum, nullptr);
+}
+
+__declspec(noinline) void localMeanStd(int height, int width, int radius,
+	const SumType* sum, const SumType* sqSum, IntensityType* mean, IntensityType* stddev)
+{
+	const int stride = (width + 1) * N_CHANNELS;
+
+	for (int i = 0; i < height; i++) {
+		const int i0 = std::max(i - radius, 0), i1 = std::min(i + radius, height - 1) + 1;
+		const SumType* top = sum + i0 * stride, * bottom = sum + i1 * stride;
+		const SumType* topSq = sqSum + i0 * stride, * bottomSq = sqSum + i1 * stride;
+
+		#pragma omp simd
+		for (int j = 0; j < width; j++) {
+			const int j0 = std::max(j - radius, 0), j1 = std::min(j + radius, width - 1) + 1;
+			const SumType invArea = (SumType)1 / ((i1 - i0) * (j1 - j0));
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++) {
+				const int a = j0 * N_CHANNELS + k, b = j1 * N_CHANNELS + k;
+				const SumType s = bottom[b] - bottom[a] - top[b] + top[a];
+				const SumType s2 = bottomSq[b] - bottomSq[a] - topSq[b] + topSq[a];
+				const SumType m = s * invArea;
+				const SumType var = s2 * invArea - m * m;
+				const int index = (i * width + j) * N_CHANNELS + k;
+				mean[index] = (IntensityType)m;
+				stddev[index] = (IntensityType)std::sqrt(var > 0 ? var : 0);
+			}
+		}
+	}
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("smile.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	std::vector<SumType> sum((height + 1) * (width + 1) * N_CHANNELS);
+	std::vector<SumType> sqSum(sum.size());
+	std::vector<IntensityType> mean(pixels.size()), stddev(pixels.size());
+
+	auto t0 = std::chrono::steady_clock::now();
+	integral(height, width, pixels.data(), sum.data(), sqSum.data());
+	auto t1 = std::chrono::steady_clock::now();
+	localMeanStd(height, width, RADIUS, sum.data(), sqSum.data(), mean.data(), stddev.data());
+	auto t2 = std::chrono::steady_clock::now();
+	float timeIntegral = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+	float timeLocal = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+
+	std::cout << "Integral time is " << timeIntegral/1e6 << " sec" << std::endl;
+	std::cout << "Local mean/stddev time is " << timeLocal/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "integral", { timeIntegral / 1e6 });
+	saveResult(argv[0], "localMeanStd", { timeLocal / 1e6 });
+
+	reader.saveRGB(std::string(argv[0]) + "_mean.bmp", mean);
+	reader.saveRGB(std::string(argv[0]) + "_stddev.bmp", stddev);
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+using SumType = double;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int WINDOW_HEIGHT = 5;  // K rows are kept
+const int RADIUS = 2;  // window width is 2*RADIUS+1
+
+
+// Integral image over the last K rows of a stream (line-scan input).
+// Only K accumulated rows (row prefix sums) are kept in a ring buffer, plus their
+// column-wise sum, so memory is O(width * K) and each row costs O(width).
+class StreamingIntegral {
+
+	const int width, windowHeight;
+	const int stride;  // (width + 1) * N_CHANNELS, the leading zero column included
+	long long nRows = 0;  // rows received so far
+
+	std::vector<SumType> ring;  // windowHeight row prefix sums
+	std::vector<SumType> window;  // sum of the rows in the ring, i.e. one row of the SAT of the window
+
+public:
+
+	StreamingIntegral(int width, int windowHeight) :
+		width(width), windowHeight(windowHeight), stride((width + 1) * N_CHANNELS),
+		ring(windowHeight * stride, 0), window(stride, 0) {}
+
+	// consumes one row, returns true if the window is full
+	__declspec(noinline) bool pushRow(const IntensityType* row) {
+		const int slot = nRows % windowHeight;
+		SumType* prefix = ring.data() + slot * stride;
+
+		SumType rowSum[N_CHANNELS] = {};
+		for (int j = 0; j < width; j++)
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++) {
+				const int index = (j + 1) * N_CHANNELS + k;
+				rowSum[k] += row[j * N_CHANNELS + k];
+				window[index] += rowSum[k] - prefix[index];  // the oldest row leaves the window
+				prefix[index] = rowSum[k];
+			}
+		nRows++;
+
+		// rebuild from the ring once per K rows so rounding errors of
+		// non-integer data do not accumulate over an endless stream
+		if (slot == windowHeight - 1)
+			resync();
+
+		return isReady();
+	}
+
+	bool isReady() const { return nRows >= windowHeight; }
+
+	long long getRowCount() const { return nRows; }
+
+	// mean over the last K rows and columns [j - radius, j + radius] clamped to the row
+	__declspec(noinline) void boxMean(int radius, IntensityType* result) const {
+		const SumType* w = window.data();
+
+		#pragma omp simd
+		for (int j = 0; j < width; j++) {
+			const int j0 = std::max(j - radius, 0), j1 = std::min(j + radius, width - 1) + 1;
+			const SumType invArea = (SumType)1 / (windowHeight * (j1 - j0));
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++)
+				result[j * N_CHANNELS + k] = (IntensityType)
+					((w[j1 * N_CHANNELS + k] - w[j0 * N_CHANNELS + k]) * invArea);
+		}
+	}
+
+private:
+
+	void resync() {
+		#pragma omp simd
+		for (int index = 0; index < stride; index++) {
+			SumType s = 0;
+			for (int r = 0; r < windowHeight; r++)
+				s += ring[r * stride + index];
+			window[index] = s;
+		}
+	}
+
+};
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("smile.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+	const int rowSize = width * N_CHANNELS;
+
+	std::vector<IntensityType> resPixels(pixels.size(), MIN_INTENSITY);
+	StreamingIntegral stream(width, WINDOW_HEIGHT);
+
+	// rows arrive one at a time, each output row is the center of the current window
+	float maxRowTime = 0.0f;
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < height; i++) {
+		auto r0 = std::chrono::steady_clock::now();
+		if (stream.pushRow(pixels.data() + i * rowSize))
+			stream.boxMean(RADIUS, resPixels.data() + (i - WINDOW_HEIGHT / 2) * rowSize);
+		auto r1 = std::chrono::steady_clock::now();
+		maxRowTime = std::max(maxRowTime,
+			(float)std::chrono::duration_cast<std::chrono::microseconds>(r1 - r0).count());
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	std::cout << "Max row latency is " << maxRowTime/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "StreamingIntegral", { time / 1e6 });
+
+	reader.saveRGB(std::string(argv[0]) + "_result.bmp", resPixels);
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+using SumType = double;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int STRIP_SIZE = 1024;  // row elements per thread in the column pass
+
+
+// Summed-area table computed in place and normalized to [0, MAX_INTENSITY].
+// Pass 1 does the row prefix sums, pass 2 the column sums. The maximum of a SAT
+// of non-negative pixels is its bottom-right element, which is the sum of the row
+// totals known after pass 1, so pass 2 writes the normalized values directly and
+// no separate max search or rescale pass over the image is needed.
+__declspec(noinline) void integral(int height, int width,
+	IntensityType* pixels)
+{
+	const int rowSize = width * N_CHANNELS;
+	std::vector<SumType> rowTotal(height * N_CHANNELS);
+
+	// pass 1: prefix sums along the rows
+	#pragma omp parallel for
+	for (int i = 0; i < height; i++) {
+		IntensityType* row = pixels + i * rowSize;
+		for (int j = 1; j < width; j++)
+			#pragma unroll
+			for (int k = 0; k < N_CHANNELS; k++)
+				row[j * N_CHANNELS + k] += row[(j - 1) * N_CHANNELS + k];
+		for (int k = 0; k < N_CHANNELS; k++)
+			rowTotal[i * N_CHANNELS + k] = row[(width - 1) * N_CHANNELS + k];
+	}
+
+	// bottom-right element of every channel, the brightest one sets the scale
+	SumType total[N_CHANNELS] = {};
+	for (int i = 0; i < height; i++)
+		for (int k = 0; k < N_CHANNELS; k++)
+			total[k] += rowTotal[i * N_CHANNELS + k];
+	const SumType maxValue = *std::max_element(total, total + N_CHANNELS);
+	const SumType scale = maxValue > 0 ? MAX_INTENSITY / maxValue : 0;
+
+	// pass 2: prefix sums along the columns, stored already normalized
+	const int nStrips = (rowSize + STRIP_SIZE - 1) / STRIP_SIZE;
+	#pragma omp parallel for
+	for (int s = 0; s < nStrips; s++) {
+		const int begin = s * STRIP_SIZE;
+		const int size = std::min(STRIP_SIZE, rowSize - begin);
+		alignas(64) SumType acc[STRIP_SIZE] = {};
+
+		for (int i = 0; i < height; i++) {
+			IntensityType* row = pixels + i * rowSize + begin;
+			#pragma omp simd aligned(acc : 64)
+			for (int e = 0; e < size; e++) {
+				acc[e] += row[e];
+				row[e] = (IntensityType)(acc[e] * scale);
+			}
+		}
+	}
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("smile.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	auto t0 = std::chrono::steady_clock::now();
+	integral(height, width, pixels.data());
+	auto t1 = std::chrono::steady_clock::now();
+	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "integral", { time / 1e6 });
+	reader.saveRGB(std::string(argv[0]) + "_result.bmp", pixels);
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+using SumType = double;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int STRIP_SIZE = 1024;  // row elements per thread in the column pass
+const int N_FRAMES = 64;
+const int SPRITE_SIZE = 8;
+
+
+struct Rect {
+	int y, x;  // top-left corner
+	int height, width;
+};
+
+
+// Summed-area table that keeps its source image and can be patched in place.
+// sum[((i+1)*(width+1) + (j+1))*N_CHANNELS + k] is the sum over [0..i] x [0..j].
+class IntegralImage {
+
+	const int height, width;
+	const int stride;  // (width + 1) * N_CHANNELS
+	std::vector<IntensityType> pixels;
+	std::vector<SumType> sum;
+
+public:
+
+	IntegralImage(int height, int width, const IntensityType* pixels) :
+		height(height), width(width), stride((width + 1) * N_CHANNELS),
+		pixels(pixels, pixels + height * width * N_CHANNELS),
+		sum((height + 1) * stride, 0)
+	{
+		build();
+	}
+
+	// full recomputation from the stored image
+	__declspec(noinline) void build() {
+		const int rowSize = width * N_CHANNELS;
+
+		#pragma omp parallel for
+		for (int i = 0; i < height; i++) {
+			const IntensityType* src = pixels.data() + i * rowSize;
+			SumType* row = sum.data() + (i + 1) * stride;
+			SumType rowSum[N_CHANNELS] = {};
+			for (int j = 0; j < width; j++)
+				#pragma unroll
+				for (int k = 0; k < N_CHANNELS; k++) {
+					rowSum[k] += src[j * N_CHANNELS + k];
+					row[(j + 1) * N_CHANNELS + k] = rowSum[k];
+				}
+		}
+
+		const int nStrips = (stride + STRIP_SIZE - 1) / STRIP_SIZE;
+		#pragma omp parallel for
+		for (int s = 0; s < nStrips; s++) {
+			const int begin = s * STRIP_SIZE;
+			const int size = std::min(STRIP_SIZE, stride - begin);
+			for (int i = 1; i < height; i++) {
+				const SumType* prev = sum.data() + i * stride + begin;
+				SumType* row = sum.data() + (i + 1) * stride + begin;
+				#pragma omp simd
+				for (int e = 0; e < size; e++)
+					row[e] += prev[e];
+			}
+		}
+	}
+
+	// Replaces the pixels inside rect (newPixels is rect.height x rect.width x N_CHANNELS)
+	// and patches the table. Only entries below and to the right of the rect's top-left
+	// corner depend on it; they get the SAT of the pixel deltas added, clamped to the rect.
+	__declspec(noinline) void update(const Rect& rect, const IntensityType* newPixels) {
+		const int dStride = (rect.width + 1) * N_CHANNELS;
+		std::vector<SumType> delta((rect.height + 1) * dStride, 0);
+
+		for (int i = 0; i < rect.height; i++) {
+			IntensityType* stored = pixels.data() + ((rect.y + i) * width + rect.x) * N_CHANNELS;
+			const IntensityType* fresh = newPixels + i * rect.width * N_CHANNELS;
+			const SumType* prev = delta.data() + i * dStride;
+			SumType* row = delta.data() + (i + 1) * dStride;
+			SumType rowSum[N_CHANNELS] = {};
+			for (int j = 0; j < rect.width; j++)
+				#pragma unroll
+				for (int k = 0; k < N_CHANNELS; k++) {
+					const int index = j * N_CHANNELS + k;
+					rowSum[k] += (SumType)fresh[index] - stored[index];
+					row[index + N_CHANNELS] = prev[index + N_CHANNELS] + rowSum[k];
+					stored[index] = fresh[index];
+				}
+		}
+
+		const int rectSize = rect.width * N_CHANNELS;
+		const int tailSize = (width - rect.x - rect.width) * N_CHANNELS;
+
+		#pragma omp parallel for
+		for (int i = rect.y; i < height; i++) {
+			const SumType* d = delta.data() + (std::min(i - rect.y, rect.height - 1) + 1) * dStride;
+			SumType* row = sum.data() + (i + 1) * stride + (rect.x + 1) * N_CHANNELS;
+
+			#pragma omp simd
+			for (int e = 0; e < rectSize; e++)
+				row[e] += d[e + N_CHANNELS];
+
+			// right of the rect every entry gets the full row delta
+			const SumType* last = d + rect.width * N_CHANNELS;
+			SumType* tail = row + rectSize;
+			for (int j = 0; j < tailSize; j += N_CHANNELS)
+				#pragma unroll
+				for (int k = 0; k < N_CHANNELS; k++)
+					tail[j + k] += last[k];
+		}
+	}
+
+	// sum over rows [i0, i1) and columns [j0, j1) of channel k
+	SumType boxSum(int i0, int j0, int i1, int j1, int k) const {
+		return sum[(i1 * (width + 1) + j1) * N_CHANNELS + k] - sum[(i0 * (width + 1) + j1) * N_CHANNELS + k] -
+			sum[(i1 * (width + 1) + j0) * N_CHANNELS + k] + sum[(i0 * (width + 1) + j0) * N_CHANNELS + k];
+	}
+
+	const std::vector<SumType>& getSums() const { return sum; }
+
+	// table without the padding, scaled to [0, MAX_INTENSITY]
+	std::vector<IntensityType> getNormalized() const {
+		SumType maxValue = 0;
+		for (int k = 0; k < N_CHANNELS; k++)
+			maxValue = std::max(maxValue, boxSum(0, 0, height, width, k));
+		const SumType scale = maxValue > 0 ? MAX_INTENSITY / maxValue : 0;
+
+		std::vector<IntensityType> result(height * width * N_CHANNELS);
+		for (int i = 0; i < height; i++)
+			#pragma omp simd
+			for (int e = 0; e < width * N_CHANNELS; e++)
+				result[i * width * N_CHANNELS + e] =
+					(IntensityType)(sum[(i + 1) * stride + N_CHANNELS + e] * scale);
+		return result;
+	}
+
+};
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("smile.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	IntegralImage image(height, width, pixels.data());
+
+	// a sprite moving along the diagonal, only its old and new positions change per frame
+	const int size = std::min(SPRITE_SIZE, std::min(height, width));
+	std::vector<IntensityType> sprite(size * size * N_CHANNELS, MAX_INTENSITY);
+	std::vector<IntensityType> background(sprite.size());
+
+	float timeUpdate = 0.0f, timeBuild = 0.0f;
+	std::vector<double> updateSamples, buildSamples;  // sec per frame
+	Rect prev = { 0, 0, 0, 0 };
+	for (int frame = 0; frame < N_FRAMES; frame++) {
+		Rect cur = { frame % (height - size + 1), frame % (width - size + 1), size, size };
+
+		auto t0 = std::chrono::steady_clock::now();
+		if (prev.height > 0) {
+			for (int i = 0; i < size; i++)
+				std::copy_n(pixels.begin() + ((prev.y + i) * width + prev.x) * N_CHANNELS,
+					size * N_CHANNELS, background.begin() + i * size * N_CHANNELS);
+			image.update(prev, background.data());
+		}
+		image.update(cur, sprite.data());
+		auto t1 = std::chrono::steady_clock::now();
+		prev = cur;
+
+		// reference: the whole table from scratch
+		std::vector<IntensityType> frameImage = pixels;
+		for (int i = 0; i < size; i++)
+			std::copy(sprite.begin() + i * size * N_CHANNELS, sprite.begin() + (i + 1) * size * N_CHANNELS,
+				frameImage.begin() + ((cur.y + i) * width + cur.x) * N_CHANNELS);
+		auto t2 = std::chrono::steady_clock::now();
+		IntegralImage reference(height, width, frameImage.data());
+		auto t3 = std::chrono::steady_clock::now();
+
+		if (reference.getSums() != image.getSums()) {
+			std::cout << "ERROR: WRONG RESULT ON FRAME " << frame << std::endl;
+			return 0;
+		}
+
+		timeUpdate += std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+		timeBuild += std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
+		updateSamples.push_back(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1e6);
+		buildSamples.push_back(std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1e6);
+	}
+
+	std::cout << "Update time is " << timeUpdate/1e6/N_FRAMES << " sec per frame" << std::endl;
+	std::cout << "Rebuild time is " << timeBuild/1e6/N_FRAMES << " sec per frame" << std::endl;
+	saveResult(argv[0], "update", updateSamples);
+	saveResult(argv[0], "build", buildSamples);
+
+	reader.saveRGB(std::string(argv[0]) + "_result.bmp", image.getNormalized());
+
+	return 0;
+}
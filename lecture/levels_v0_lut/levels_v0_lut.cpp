@@ -0,0 +1,179 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+#include <cstdint>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+#include "../trace.h"
+
+
+using IntensityType = uint8_t;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int N_BINS = 256;
+const int N_SUB = 4;  // sub-histograms per thread, see histogram_v0_privatized
+const double CLIP_FRACTION = 0.005;  // auto-levels ignores the darkest and brightest 0.5%
+
+
+// pass 1: bins[k * N_BINS + v] is the number of pixels with value v in channel k
+__declspec(noinline) void histogram(int height, int width,
+	const IntensityType* pixels, uint64_t* bins)
+{
+	TRACE_SCOPE("histogram");
+	std::fill(bins, bins + N_CHANNELS * N_BINS, 0);
+
+	#pragma omp parallel
+	{
+		TRACE_SCOPE("histogram thread");
+		alignas(64) uint32_t sub[N_SUB][N_CHANNELS][N_BINS] = {};
+
+		#pragma omp for schedule(static)
+		for (int i = 0; i < height; i++) {
+			const IntensityType* row = pixels + i * width * N_CHANNELS;
+			const int nBody = width / N_SUB * N_SUB;
+			for (int j = 0; j < nBody; j += N_SUB)
+				#pragma unroll
+				for (int s = 0; s < N_SUB; s++) {
+					const IntensityType* p = row + (j + s) * N_CHANNELS;
+					sub[s][0][p[0]]++;
+					sub[s][1][p[1]]++;
+					sub[s][2][p[2]]++;
+				}
+			for (int j = nBody; j < width; j++)
+				for (int k = 0; k < N_CHANNELS; k++)
+					sub[j % N_SUB][k][row[j * N_CHANNELS + k]]++;
+		}
+
+		#pragma omp critical
+		for (int k = 0; k < N_CHANNELS; k++)
+			for (int v = 0; v < N_BINS; v++)
+				for (int s = 0; s < N_SUB; s++)
+					bins[k * N_BINS + v] += sub[s][k][v];
+	}
+}
+
+// linear stretch of [low, high] to the full range, low and high are the
+// CLIP_FRACTION and 1 - CLIP_FRACTION percentiles of the channel
+void buildLevelsLut(const uint64_t* bins, uint8_t* lut)
+{
+	TRACE_SCOPE("buildLevelsLut");
+	for (int k = 0; k < N_CHANNELS; k++) {
+		const uint64_t* h = bins + k * N_BINS;
+		uint64_t count = 0;
+		for (int v = 0; v < N_BINS; v++)
+			count += h[v];
+
+		int low = 0, high = N_BINS - 1;
+		uint64_t cdf = 0;
+		while (low < N_BINS - 1 && (cdf += h[low]) <= CLIP_FRACTION * count)
+			low++;
+		cdf = 0;
+		while (high > 0 && (cdf += h[high]) <= CLIP_FRACTION * count)
+			high--;
+
+		for (int v = 0; v < N_BINS; v++) {
+			float res = high > low ? (float)(v - low) * MAX_INTENSITY / (high - low) : v;
+			if (res < MIN_INTENSITY) res = MIN_INTENSITY;
+			if (res > MAX_INTENSITY) res = MAX_INTENSITY;
+			lut[k * N_BINS + v] = (uint8_t)(res + 0.5f);
+		}
+	}
+}
+
+// histogram equalization: the value goes to its normalized position in the CDF
+void buildEqualizationLut(const uint64_t* bins, uint8_t* lut)
+{
+	TRACE_SCOPE("buildEqualizationLut");
+	for (int k = 0; k < N_CHANNELS; k++) {
+		const uint64_t* h = bins + k * N_BINS;
+		uint64_t count = 0, cdfMin = 0;
+		for (int v = 0; v < N_BINS; v++) {
+			if (cdfMin == 0) cdfMin = h[v];
+			count += h[v];
+		}
+
+		uint64_t cdf = 0;
+		for (int v = 0; v < N_BINS; v++) {
+			cdf += h[v];
+			lut[k * N_BINS + v] = count > cdfMin ?
+				(uint8_t)std::lround((double)(cdf > cdfMin ? cdf - cdfMin : 0) / (count - cdfMin) * MAX_INTENSITY) :
+				(uint8_t)v;
+		}
+	}
+}
+
+// pass 2: the same loop shape as nonlinearCorrection, the pixel function is a table lookup
+__declspec(noinline) void applyLut(int height, int width, const uint8_t* lut,
+	const IntensityType* pixels, IntensityType* result)
+{
+	TRACE_SCOPE("applyLut");
+	#pragma omp parallel for
+	for (int i = 0; i < height; i++) {
+		const int offset = i * width * N_CHANNELS;
+		#pragma ivdep
+		for (int j = 0; j < width; j++) {
+			const int index = offset + N_CHANNELS * j;
+			result[index] = lut[pixels[index]];
+			result[index + 1] = lut[N_BINS + pixels[index + 1]];
+			result[index + 2] = lut[2 * N_BINS + pixels[index + 2]];
+		}
+	}
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	std::vector<IntensityType> pixels;
+	{
+		TRACE_SCOPE("load");
+		if (!reader.open("photo.bmp")) {
+			std::cout << "Error when reading" << std::endl;
+			return 0;
+		}
+		pixels = reader.getRGBPixels<IntensityType>();
+	}
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	std::vector<IntensityType> levelsPixels(pixels.size()), equalizedPixels(pixels.size());
+	std::vector<uint64_t> bins(N_CHANNELS * N_BINS);
+	std::vector<uint8_t> levelsLut(N_CHANNELS * N_BINS), equalizationLut(N_CHANNELS * N_BINS);
+
+	auto t0 = std::chrono::steady_clock::now();
+	histogram(height, width, pixels.data(), bins.data());
+	auto t1 = std::chrono::steady_clock::now();
+	buildLevelsLut(bins.data(), levelsLut.data());
+	buildEqualizationLut(bins.data(), equalizationLut.data());
+	auto t2 = std::chrono::steady_clock::now();
+	applyLut(height, width, levelsLut.data(), pixels.data(), levelsPixels.data());
+	auto t3 = std::chrono::steady_clock::now();
+	applyLut(height, width, equalizationLut.data(), pixels.data(), equalizedPixels.data());
+	auto t4 = std::chrono::steady_clock::now();
+
+	std::cout << "Statistics time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()/1e6 << " sec" << std::endl;
+	std::cout << "LUT time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()/1e6 << " sec" << std::endl;
+	std::cout << "Auto-levels time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()/1e6 << " sec" << std::endl;
+	std::cout << "Equalization time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "histogram", { std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1e6 });
+	saveResult(argv[0], "buildLut", { std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1e6 });
+	saveResult(argv[0], "applyLut levels", { std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1e6 });
+	saveResult(argv[0], "applyLut equalization", { std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count() / 1e6 });
+
+	{
+		TRACE_SCOPE("save");
+		reader.saveRGB(std::string(argv[0]) + "_levels.bmp", levelsPixels);
+		reader.saveRGB(std::string(argv[0]) + "_equalized.bmp", equalizedPixels);
+	}
+	TRACE_SAVE(std::string(argv[0]) + "_trace.json");
+
+	return 0;
+}
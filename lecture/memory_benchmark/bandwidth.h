@@ -0,0 +1,261 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+
+#include "benchmark_utils.h"
+#include "../perf_counters.h"
+
+
+using ValueType = float;
+const ValueType SCALAR = 3.0f;
+const long long MIN_SIZE = 4 * KB;
+const long long TRIAL_TRAFFIC = 256 * MB;  // bytes moved per trial, small working sets are repeated
+const int LINE_ELEMENTS = 64 / sizeof(ValueType);
+const int READ_LANES = 4 * LINE_ELEMENTS;  // 4 zmm accumulators, one would be bound by the add latency
+const int BUFFER_PADDING = 128;  // bytes of the buffer after the working set, room for the array offsets
+
+ValueType sink;  // the read kernel stores its sum here so that the loads are not removed
+
+
+// STREAM-like kernels, x and y are read, z is written
+__declspec(noinline) void readKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	alignas(64) ValueType acc[READ_LANES] = {};
+	const long long nBody = n / READ_LANES * READ_LANES;
+	for (long long i = 0; i < nBody; i += READ_LANES)
+		#pragma omp simd aligned(acc : 64)
+		for (int l = 0; l < READ_LANES; l++)
+			acc[l] += x[i + l];
+	for (long long i = nBody; i < n; i++)
+		acc[0] += x[i];
+
+	ValueType sum = 0;
+	for (int l = 0; l < READ_LANES; l++)
+		sum += acc[l];
+	sink = sum;
+}
+
+__declspec(noinline) void writeKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = SCALAR;
+}
+
+__declspec(noinline) void copyKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = x[i];
+}
+
+__declspec(noinline) void scaleKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = SCALAR * x[i];
+}
+
+__declspec(noinline) void addKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = x[i] + y[i];
+}
+
+__declspec(noinline) void triadKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = x[i] + SCALAR * y[i];
+}
+
+
+// Stores that bypass the cache: the line is not read before it is written and
+// nothing useful is evicted, but the data has to come back from memory if it
+// is used again. The vector stores need z aligned to the vector size.
+__declspec(noinline) void streamCopyKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	long long i = 0;
+	for (; i < n && (uintptr_t)(z + i) % 64 != 0; i++)
+		z[i] = x[i];
+#if defined(__AVX512F__)
+	for (; i + 16 <= n; i += 16)
+		_mm512_stream_ps(z + i, _mm512_loadu_ps(x + i));
+#elif defined(__AVX__)
+	for (; i + 8 <= n; i += 8)
+		_mm256_stream_ps(z + i, _mm256_loadu_ps(x + i));
+#else
+	for (; i + 4 <= n; i += 4)
+		_mm_stream_ps(z + i, _mm_loadu_ps(x + i));
+#endif
+	for (; i < n; i++)
+		z[i] = x[i];
+	_mm_sfence();  // streaming stores are weakly ordered
+}
+
+// Copy with unaligned vector loads and stores and no peel loop, so the offsets
+// of x and z stay as they are. The compiler would align one of the arrays first
+// or call its memcpy for the plain copy loop.
+__declspec(noinline) void vectorCopyKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	long long i = 0;
+#if defined(__AVX512F__)
+	for (; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(z + i, _mm512_loadu_ps(x + i));
+#elif defined(__AVX__)
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(z + i, _mm256_loadu_ps(x + i));
+#else
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(z + i, _mm_loadu_ps(x + i));
+#endif
+	for (; i < n; i++)
+		z[i] = x[i];
+}
+
+// copy with one software prefetch per cache line of x, DISTANCE bytes ahead
+// (a prefetch past the end of the array does not fault)
+template <int DISTANCE>
+__declspec(noinline) void prefetchCopyKernel(long long n, const ValueType* x, const ValueType* y, ValueType* z)
+{
+	for (long long i = 0; i < n; i += LINE_ELEMENTS) {
+		_mm_prefetch((const char*)(x + i) + DISTANCE, _MM_HINT_T0);
+		#pragma ivdep
+		for (int l = 0; l < LINE_ELEMENTS; l++)
+			z[i + l] = x[i + l];
+	}
+}
+
+
+struct BandwidthKernel {
+	const char* name;
+	int nInputs, nOutputs;
+	void (*run)(long long n, const ValueType* x, const ValueType* y, ValueType* z);
+	int inputOffset, outputOffset;  // bytes by which x, y and z are moved off the 64-byte boundaries
+};
+
+// Only the bytes the program asks for are counted, as in STREAM. A store to a
+// line that is not cached also reads it first (write-allocate), so the write,
+// copy, scale, add and triad numbers are below what the bus really moves.
+const std::vector<BandwidthKernel> BANDWIDTH_KERNELS = {
+	{ "read", 1, 0, readKernel, 0, 0 },
+	{ "write", 0, 1, writeKernel, 0, 0 },
+	{ "copy", 1, 1, copyKernel, 0, 0 },
+	{ "scale", 1, 1, scaleKernel, 0, 0 },
+	{ "add", 2, 1, addKernel, 0, 0 },
+	{ "triad", 2, 1, triadKernel, 0, 0 }
+};
+
+// copy with cached stores on aligned arrays against the other ways to do it
+const std::vector<BandwidthKernel> VARIANT_KERNELS = {
+	{ "copy", 1, 1, copyKernel, 0, 0 },
+	{ "stream", 1, 1, streamCopyKernel, 0, 0 },
+	{ "pf 256", 1, 1, prefetchCopyKernel<256>, 0, 0 },
+	{ "pf 1K", 1, 1, prefetchCopyKernel<1024>, 0, 0 },
+	{ "pf 4K", 1, 1, prefetchCopyKernel<4096>, 0, 0 },
+	{ "vec copy", 1, 1, vectorCopyKernel, 0, 0 },
+	{ "vec mis", 1, 1, vectorCopyKernel, 4, 4 },  // every vector load and store splits a line
+	{ "stream mis", 1, 1, streamCopyKernel, 4, 0 }  // x splits lines, z is aligned by the kernel
+};
+
+
+struct BandwidthResult {
+	std::string kernel;
+	long long size;  // working set: all arrays of the kernel together
+	double best, mean;  // GB/s
+	double counters[PerfCounters::N_COUNTERS];  // per 64 bytes moved, negative if not available
+};
+
+// The arrays of the kernel are cut one after another from the start of the
+// buffer, so the working set is exactly the given size (rounded to cache lines).
+// The buffer is 64-byte aligned and has BUFFER_PADDING bytes more for the offsets,
+// z starts a line after the inputs if any array is moved.
+BandwidthResult measureBandwidth(const BandwidthKernel& kernel, long long size, ValueType* buffer,
+	PerfCounters& counters)
+{
+	const int nArrays = kernel.nInputs + kernel.nOutputs;
+	const long long n = size / sizeof(ValueType) / nArrays / LINE_ELEMENTS * LINE_ELEMENTS;
+	const bool moved = kernel.inputOffset != 0 || kernel.outputOffset != 0;
+	const ValueType* x = buffer + kernel.inputOffset / sizeof(ValueType);
+	const ValueType* y = x + (kernel.nInputs > 1 ? n : 0);
+	ValueType* z = buffer + kernel.nInputs * n + (moved ? LINE_ELEMENTS : 0) + kernel.outputOffset / sizeof(ValueType);
+	const double bytes = (double)n * nArrays * sizeof(ValueType);
+	const long long repeats = std::max(1LL, TRIAL_TRAFFIC / (long long)bytes);
+
+	kernel.run(n, x, y, z);  // warm-up, brings the working set into the cache it fits in
+
+	BandwidthResult result = { kernel.name, (long long)bytes, 0.0, 0.0 };
+	counters.start();
+	Timer timer;
+	for (int trial = 0; trial < N_TRIALS; trial++) {
+		timer.lap();
+		for (long long r = 0; r < repeats; r++)
+			kernel.run(n, x, y, z);
+		const double bandwidth = bytes * repeats / timer.lap() / 1e9;
+		result.best = std::max(result.best, bandwidth);
+		result.mean += bandwidth / N_TRIALS;
+	}
+	counters.stop();
+
+	const double lines = bytes * repeats * N_TRIALS / 64;
+	for (int k = 0; k < PerfCounters::N_COUNTERS; k++) {
+		const PerfCounters::Counter counter = (PerfCounters::Counter)k;
+		result.counters[k] = counters.isAvailable(counter) ? counters.getValue(counter) / lines : -1.0;
+	}
+	return result;
+}
+
+// GB/s of every kernel for working sets from MIN_SIZE to maxSize,
+// printed as a table while it runs
+std::vector<BandwidthResult> bandwidthSweep(const std::vector<BandwidthKernel>& kernels,
+	long long maxSize, ValueType* buffer)
+{
+	std::vector<BandwidthResult> results;
+	PerfCounters counters;
+
+	std::cout << std::setw(10) << "Size";
+	for (const BandwidthKernel& kernel : kernels)
+		std::cout << std::setw(11) << kernel.name;
+	std::cout << "   (best GB/s of " << N_TRIALS << " trials)" << std::endl;
+
+	for (long long size : sweepSizes(MIN_SIZE, maxSize)) {
+		std::cout << std::setw(10) << formatSize(size);
+		for (const BandwidthKernel& kernel : kernels) {
+			results.push_back(measureBandwidth(kernel, size, buffer, counters));
+			std::cout << std::setw(11) << std::fixed << std::setprecision(2) << results.back().best << std::flush;
+		}
+		std::cout << std::endl;
+	}
+	if (!results.empty() && results.front().counters[PerfCounters::CYCLES] < 0)
+		std::cout << "Hardware counters are not available" << std::endl;
+	return results;
+}
+
+void saveBandwidthCsv(const std::string& fileName, const std::vector<BandwidthResult>& results)
+{
+	std::ofstream file(fileName);
+	file << "kernel,size_bytes,best_gbps,mean_gbps";
+	for (int k = 0; k < PerfCounters::N_COUNTERS; k++) {
+		std::string name = PerfCounters::getName((PerfCounters::Counter)k);
+		std::replace(name.begin(), name.end(), '-', '_');
+		file << "," << name << "_per_line";
+	}
+	file << std::endl;
+
+	for (const BandwidthResult& result : results) {
+		file << result.kernel << "," << result.size << "," << result.best << "," << result.mean;
+		for (int k = 0; k < PerfCounters::N_COUNTERS; k++) {
+			file << ",";
+			if (result.counters[k] >= 0)
+				file << result.counters[k];
+		}
+		file << std::endl;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+
+const long long KB = 1LL << 10, MB = 1LL << 20, GB = 1LL << 30;
+const int N_TRIALS = 5;  // the best trial is reported, the mean shows the noise
+
+
+// 4K, 6K, 8K, 12K, ...: powers of two and the midpoints between them, so the
+// steps of the curve at the cache sizes are visible
+std::vector<long long> sweepSizes(long long minSize, long long maxSize)
+{
+	std::vector<long long> sizes;
+	for (long long size = minSize; size <= maxSize; size *= 2) {
+		sizes.push_back(size);
+		if (size + size / 2 <= maxSize)
+			sizes.push_back(size + size / 2);
+	}
+	return sizes;
+}
+
+std::string formatSize(long long bytes)
+{
+	char buffer[32];
+	if (bytes >= GB && bytes % (GB / 2) == 0)
+		std::snprintf(buffer, sizeof(buffer), "%g GB", (double)bytes / GB);
+	else if (bytes >= MB && bytes % (MB / 2) == 0)
+		std::snprintf(buffer, sizeof(buffer), "%g MB", (double)bytes / MB);
+	else
+		std::snprintf(buffer, sizeof(buffer), "%g KB", (double)bytes / KB);
+	return buffer;
+}
+
+// seconds since the previous call
+class Timer {
+
+	std::chrono::steady_clock::time_point start;
+
+public:
+
+	Timer() : start(std::chrono::steady_clock::now()) {}
+
+	double lap() {
+		auto now = std::chrono::steady_clock::now();
+		double time = std::chrono::duration<double>(now - start).count();
+		start = now;
+		return time;
+	}
+
+};
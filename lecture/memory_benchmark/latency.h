@@ -0,0 +1,111 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+#include "benchmark_utils.h"
+#include "page_buffer.h"
+
+
+const long long LATENCY_MIN_SIZE = 4 * KB;
+const long long LATENCY_LOADS = 1 << 20;  // dependent loads per trial, 0.1-0.2 s in DRAM
+const unsigned LATENCY_SEED = 2023;
+
+
+// one node per cache line, so every load of the chain touches a new line
+struct Node {
+	Node* next;
+	char padding[64 - sizeof(Node*)];
+};
+
+Node* latencySink;  // the end of the chase is stored here so that it is not removed
+
+
+// Links the first n nodes into a single random cycle (Sattolo's algorithm).
+// The next line is unknown until the load returns and the order defeats the
+// prefetchers, so the time per step is the load-to-use latency of the level
+// the n lines fit in.
+void buildChain(Node* nodes, long long n)
+{
+	std::vector<uint32_t> order(n);
+	for (long long i = 0; i < n; i++)
+		order[i] = (uint32_t)i;
+
+	std::mt19937 generator(LATENCY_SEED);
+	for (long long i = n - 1; i > 0; i--) {
+		std::uniform_int_distribution<long long> distribution(0, i - 1);
+		std::swap(order[i], order[distribution(generator)]);
+	}
+
+	for (long long i = 0; i < n; i++)
+		nodes[i].next = nodes + order[i];
+}
+
+__declspec(noinline) Node* chase(Node* node, long long steps)
+{
+	for (long long s = 0; s < steps; s++)
+		node = node->next;
+	return node;
+}
+
+
+struct LatencyResult {
+	std::string pages;
+	long long size;
+	double best, mean;  // ns per load
+};
+
+LatencyResult measureLatency(Node* nodes, long long size, const std::string& pages)
+{
+	const long long n = size / sizeof(Node);
+	buildChain(nodes, n);
+	latencySink = chase(nodes, n);  // warm-up, the whole cycle once
+
+	LatencyResult result = { pages, n * (long long)sizeof(Node), 0.0, 0.0 };
+	Timer timer;
+	for (int trial = 0; trial < N_TRIALS; trial++) {
+		timer.lap();
+		latencySink = chase(latencySink, LATENCY_LOADS);
+		const double latency = timer.lap() / LATENCY_LOADS * 1e9;
+		result.best = trial == 0 ? latency : std::min(result.best, latency);
+		result.mean += latency / N_TRIALS;
+	}
+	return result;
+}
+
+// ns per load for working sets from LATENCY_MIN_SIZE to the buffer size,
+// one table per page size
+std::vector<LatencyResult> latencySweep(long long maxSize)
+{
+	std::vector<LatencyResult> results;
+
+	for (bool hugePages : { false, true }) {
+		PageBuffer buffer(maxSize, hugePages);
+		if (!buffer.getData()) {
+			std::cout << "Cannot allocate " << formatSize(maxSize) << std::endl;
+			continue;
+		}
+		std::cout << "Latency with " << buffer.getPages() << std::endl;
+		std::cout << std::setw(10) << "Size" << std::setw(10) << "ns/load" << std::endl;
+
+		for (long long size : sweepSizes(LATENCY_MIN_SIZE, maxSize)) {
+			results.push_back(measureLatency((Node*)buffer.getData(), size, buffer.getPages()));
+			std::cout << std::setw(10) << formatSize(size) << std::setw(10) << std::fixed <<
+				std::setprecision(2) << results.back().best << std::endl;
+		}
+	}
+	return results;
+}
+
+void saveLatencyCsv(const std::string& fileName, const std::vector<LatencyResult>& results)
+{
+	std::ofstream file(fileName);
+	file << "pages,size_bytes,best_ns,mean_ns" << std::endl;
+	for (const LatencyResult& result : results)
+		file << result.pages << "," << result.size << "," << result.best << "," << result.mean << std::endl;
+}
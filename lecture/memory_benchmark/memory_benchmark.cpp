@@ -1,49 +1,58 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <cmath>
-#include <chrono>
+#include <cstdlib>
+#include <algorithm>
 
-#include "bmp_reader.h"
+#include "benchmark_utils.h"
+#include "page_buffer.h"
+#include "bandwidth.h"
+#include "latency.h"
+#include "threads.h"
 
 
-using IntensityType = float;
-const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
-const int N_CHANNELS = 3;  // RGB
-
-
-__declspec(noinline) void nonlinearCorrection(int height, int width,
-	IntensityType* pixels, IntensityType* result)
-{
-	#pragma ivdep
-	for (int i = 0; i < height * width * N_CHANNELS; i++) {
-		result[i] = pixels[i];
-	}
-}
+const long long DEFAULT_MAX_SIZE = 4 * GB;  // well past the last level cache and the TLB reach
 
 
+// memory_benchmark [mode] [max working set in MB, 4096 by default, less on a small machine]
+//   bandwidth: GB/s of read, write, copy, scale, add and triad from 4 KB up
+//   variants: copy with streaming stores, software prefetch and misaligned arrays
+//   latency: ns per dependent load with 4 KB and with huge pages
+//   threads: read and triad GB/s of 1 .. all pinned threads, local and remote NUMA memory
 int main(int argc, char** argv) {
 
-	BMPReader reader;
-	if (!reader.open("photo.bmp")) {
-		std::cout << "Error when reading" << std::endl;
+	const std::string mode = argc > 1 ? argv[1] : "bandwidth";
+	const long long maxSize = argc > 2 ? std::atoll(argv[2]) * MB : DEFAULT_MAX_SIZE;
+	if (maxSize < MIN_SIZE) {
+		std::cout << "Max working set is too small" << std::endl;
 		return 0;
 	}
 
-	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
-	const int height = reader.getHeight(), width = reader.getWidth();
-
-	std::vector<IntensityType> resPixels(pixels.size());
-	
-	   auto t0 = std::chrono::steady_clock::now();
-	   nonlinearCorrection(height, width, pixels.data(), resPixels.data());
-	   auto t1 = std::chrono::steady_clock::now();
-	   float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
-	
-	   std::cout << "Time is " << time/1e6 << " sec" << std::endl;
-	reader.setRGBPixels(resPixels);
-	
-	reader.save(std::string(argv[0]) + "_result.bmp");
-		
+	if (mode == "bandwidth" || mode == "variants") {
+		PageBuffer buffer(maxSize + BUFFER_PADDING, false);
+		ValueType* data = (ValueType*)buffer.getData();
+		if (!data) {
+			std::cout << "Cannot allocate " << formatSize(maxSize) << std::endl;
+			return 0;
+		}
+		// touches the pages, the values do not matter and zeros stay finite over all the repeats
+		std::fill(data, data + (maxSize + BUFFER_PADDING) / sizeof(ValueType), (ValueType)0);
+
+		std::vector<BandwidthResult> results = bandwidthSweep(
+			mode == "variants" ? VARIANT_KERNELS : BANDWIDTH_KERNELS, maxSize, data);
+		saveBandwidthCsv(std::string(argv[0]) + "_" + mode + ".csv", results);
+	}
+	else if (mode == "latency") {
+		std::vector<LatencyResult> results = latencySweep(maxSize);
+		saveLatencyCsv(std::string(argv[0]) + "_latency.csv", results);
+	}
+	else if (mode == "threads") {
+		std::vector<ThreadResult> results = threadSweep(maxSize);
+		saveThreadsCsv(std::string(argv[0]) + "_threads.csv", results);
+	}
+	else {
+		std::cout << "Unknown mode " << mode << ", use bandwidth, variants, latency or threads" << std::endl;
+	}
+
 	return 0;
 }
@@ -0,0 +1,160 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "advapi32.lib")
+#else
+#include <sys/mman.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+
+// Memory taken straight from the OS with 4 KB or huge pages. A huge page covers
+// 2 MB with one TLB entry, so random accesses over a large array miss the TLB far
+// less often. If huge pages cannot be had, the buffer silently falls back to
+// normal pages, getPages() tells which ones were really used.
+class PageBuffer {
+
+	void* data = nullptr;
+	void* mapping = nullptr;  // what has to be returned to the OS
+	size_t size = 0, mappingSize = 0;
+	std::string pages;
+
+#ifdef _WIN32
+	// large pages need SeLockMemoryPrivilege, granted by the "Lock pages in memory" policy
+	static bool enableLockMemoryPrivilege() {
+		HANDLE token;
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+			return false;
+		TOKEN_PRIVILEGES privileges;
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+		bool ok = LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+			AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+			GetLastError() == ERROR_SUCCESS;
+		CloseHandle(token);
+		return ok;
+	}
+
+	void allocate(bool hugePages) {
+		const size_t largePageSize = GetLargePageMinimum();
+		if (hugePages && largePageSize > 0 && enableLockMemoryPrivilege()) {
+			mappingSize = (size + largePageSize - 1) / largePageSize * largePageSize;
+			mapping = VirtualAlloc(nullptr, mappingSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (mapping) {
+				data = mapping;
+				pages = "large pages";
+				return;
+			}
+		}
+		mappingSize = size;
+		mapping = VirtualAlloc(nullptr, mappingSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		data = mapping;
+		pages = "4 KB pages";
+	}
+
+	void release() {
+		if (mapping)
+			VirtualFree(mapping, 0, MEM_RELEASE);
+	}
+#else
+	static const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+	// the selected mode of /sys/kernel/mm/transparent_hugepage/enabled:
+	// "always", "madvise", "never" or "" if there is no THP
+	static std::string getThpMode() {
+		std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+		std::string line;
+		std::getline(file, line);
+		const size_t begin = line.find('['), end = line.find(']');
+		return begin != std::string::npos && end != std::string::npos ? line.substr(begin + 1, end - begin - 1) : "";
+	}
+
+	// bytes of [begin, end) backed by transparent huge pages, AnonHugePages of the
+	// mappings in /proc/self/smaps that overlap the range
+	static size_t getAnonHugePages(uintptr_t begin, uintptr_t end) {
+		std::ifstream file("/proc/self/smaps");
+		std::string line;
+		bool inRange = false;
+		size_t bytes = 0;
+		while (std::getline(file, line)) {
+			unsigned long first, last;  // a header line of a mapping starts with its address range
+			if (std::sscanf(line.c_str(), "%lx-%lx ", &first, &last) == 2)
+				inRange = first < end && last > begin;
+			else if (inRange && line.compare(0, 14, "AnonHugePages:") == 0)
+				bytes += std::strtoull(line.c_str() + 14, nullptr, 10) << 10;
+		}
+		return bytes;
+	}
+
+	void allocate(bool hugePages) {
+		if (hugePages) {
+			// reserved huge pages (vm.nr_hugepages) first, then transparent ones
+			mappingSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+			mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (mapping != MAP_FAILED) {
+				data = mapping;
+				pages = "2 MB hugetlb pages";
+				return;
+			}
+		}
+
+		// a transparent huge page is only used for an aligned 2 MB range
+		mappingSize = size + HUGE_PAGE_SIZE;
+		mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED) {
+			mapping = nullptr;
+			return;
+		}
+		data = (void*)(((uintptr_t)mapping + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+		// without MADV_NOHUGEPAGE a kernel with THP set to "always" gives huge pages anyway
+		if (madvise(data, size, hugePages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0 || !hugePages) {
+			pages = "4 KB pages";
+			return;
+		}
+
+		// madvise only records the advice: the pages are given at the first touch, and
+		// only if THP is on and the kernel finds free 2 MB ranges
+		const std::string mode = getThpMode();
+		if (mode != "always" && mode != "madvise") {
+			pages = "4 KB pages (transparent huge pages are " + (mode.empty() ? std::string("not supported") : mode) + ")";
+			return;
+		}
+		for (size_t offset = 0; offset < size; offset += 4096)
+			((volatile char*)data)[offset] = 0;
+		const size_t hugeBytes = getAnonHugePages((uintptr_t)data, (uintptr_t)data + size);
+		if (hugeBytes == 0) {
+			pages = "4 KB pages (no transparent huge pages were given)";
+			return;
+		}
+		std::stringstream description;
+		description << "transparent huge pages (" << (hugeBytes >> 20) << " of " << (size >> 20) << " MB)";
+		pages = description.str();
+	}
+
+	void release() {
+		if (mapping)
+			munmap(mapping, mappingSize);
+	}
+#endif
+
+public:
+
+	PageBuffer(size_t size, bool hugePages) : size(size) { allocate(hugePages); }
+	~PageBuffer() { release(); }
+	PageBuffer(const PageBuffer&) = delete;
+	PageBuffer& operator=(const PageBuffer&) = delete;
+
+	void* getData() const { return data; }  // nullptr if the allocation failed
+	size_t getSize() const { return size; }
+	const std::string& getPages() const { return pages; }
+
+};
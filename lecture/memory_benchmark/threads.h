@@ -0,0 +1,246 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+#include "benchmark_utils.h"
+#include "bandwidth.h"
+#include "page_buffer.h"
+
+
+const char* THREAD_KERNELS[] = { "read", "triad" };
+
+
+struct NumaNode {
+	int id;
+	std::vector<int> cpus;
+};
+
+#ifndef _WIN32
+// "0-3,8-11" -> 0 1 2 3 8 9 10 11
+std::vector<int> parseCpuList(const std::string& list)
+{
+	std::vector<int> cpus;
+	std::stringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ',')) {
+		const size_t dash = range.find('-');
+		const int first = std::stoi(range.substr(0, dash));
+		const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+		for (int cpu = first; cpu <= last; cpu++)
+			cpus.push_back(cpu);
+	}
+	return cpus;
+}
+#endif
+
+// NUMA nodes with the CPUs the process may run on, one node with all CPUs
+// if the topology is unknown. On Windows only the first processor group.
+std::vector<NumaNode> getNumaNodes()
+{
+	std::vector<NumaNode> nodes;
+#ifdef _WIN32
+	ULONG highest = 0;
+	GetNumaHighestNodeNumber(&highest);
+	for (ULONG id = 0; id <= highest; id++) {
+		ULONGLONG mask = 0;
+		if (!GetNumaNodeProcessorMask((UCHAR)id, &mask))
+			continue;
+		NumaNode node = { (int)id, {} };
+		for (int cpu = 0; cpu < 64; cpu++)
+			if (mask >> cpu & 1)
+				node.cpus.push_back(cpu);
+		if (!node.cpus.empty())
+			nodes.push_back(node);
+	}
+#else
+	cpu_set_t allowed;
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+	std::ifstream online("/sys/devices/system/node/online");
+	std::string list;
+	if (online >> list)
+		for (int id : parseCpuList(list)) {
+			std::ifstream cpuList("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+			std::string cpus;
+			if (!(cpuList >> cpus))
+				continue;  // memory without CPUs
+			NumaNode node = { id, {} };
+			for (int cpu : parseCpuList(cpus))
+				if (CPU_ISSET(cpu, &allowed))
+					node.cpus.push_back(cpu);
+			if (!node.cpus.empty())
+				nodes.push_back(node);
+		}
+#endif
+	if (nodes.empty()) {
+		NumaNode node = { 0, {} };
+		for (int cpu = 0; cpu < omp_get_num_procs(); cpu++)
+			node.cpus.push_back(cpu);
+		nodes.push_back(node);
+	}
+	return nodes;
+}
+
+// binds the calling thread to one CPU
+bool pinThread(int cpu)
+{
+#ifdef _WIN32
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+}
+
+
+struct ThreadResult {
+	std::string kernel, placement;
+	std::vector<int> cpus;
+	double total;  // GB/s of all threads: all bytes over the time of the slowest one
+	std::vector<double> perThread;
+};
+
+// Thread t runs on cpus[t] over its own arrays. The pages are first touched by a
+// thread pinned to homeCpus[t], so they are allocated on the node of that CPU.
+ThreadResult measureThreads(const BandwidthKernel& kernel, const std::vector<int>& cpus,
+	const std::vector<int>& homeCpus, const std::string& placement, long long size)
+{
+	const int nThreads = cpus.size();
+	const int nArrays = kernel.nInputs + kernel.nOutputs;
+	const long long n = size / nThreads / sizeof(ValueType) / nArrays / LINE_ELEMENTS * LINE_ELEMENTS;
+	const double bytes = (double)n * nArrays * sizeof(ValueType);
+	const long long repeats = std::max(1LL, TRIAL_TRAFFIC / (long long)bytes);
+
+	ThreadResult result = { kernel.name, placement, cpus, 0.0, std::vector<double>(nThreads) };
+	std::vector<std::unique_ptr<PageBuffer>> buffers(nThreads);
+	for (int t = 0; t < nThreads; t++) {
+		buffers[t].reset(new PageBuffer(n * nArrays * sizeof(ValueType), false));
+		if (!buffers[t]->getData()) {
+			std::cout << "Cannot allocate " << formatSize(size) << std::endl;
+			return result;
+		}
+	}
+	std::vector<double> times(nThreads);
+
+	#pragma omp parallel num_threads(nThreads)
+	{
+		const int t = omp_get_thread_num();
+		ValueType* data = (ValueType*)buffers[t]->getData();
+		pinThread(homeCpus[t]);
+		std::fill(data, data + n * nArrays, (ValueType)0);
+		pinThread(cpus[t]);
+
+		const ValueType* x = data;
+		const ValueType* y = data + (kernel.nInputs > 1 ? n : 0);
+		ValueType* z = data + kernel.nInputs * n;
+		kernel.run(n, x, y, z);
+
+		for (int trial = 0; trial < N_TRIALS; trial++) {
+			#pragma omp barrier
+			Timer timer;
+			for (long long r = 0; r < repeats; r++)
+				kernel.run(n, x, y, z);
+			times[t] = timer.lap();
+			#pragma omp barrier
+			#pragma omp single
+			{
+				const double slowest = *std::max_element(times.begin(), times.end());
+				const double total = bytes * repeats * nThreads / slowest / 1e9;
+				if (total > result.total) {
+					result.total = total;
+					for (int i = 0; i < nThreads; i++)
+						result.perThread[i] = bytes * repeats / times[i] / 1e9;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+// 1, 2, 3, 4, 6, 8, 12, ... up to all CPUs
+std::vector<int> threadCounts(int maxThreads)
+{
+	std::vector<int> counts;
+	for (int count = 1; count <= maxThreads; count *= 2) {
+		counts.push_back(count);
+		if (count > 1 && count + count / 2 <= maxThreads)
+			counts.push_back(count + count / 2);
+	}
+	if (counts.back() != maxThreads)
+		counts.push_back(maxThreads);
+	return counts;
+}
+
+// Read and triad bandwidth over size bytes split between 1 .. all threads. Threads
+// fill node 0 first, then node 1 and so on. "local" memory is on the node of the
+// thread, "remote" memory on the next node, which only exists with several nodes.
+std::vector<ThreadResult> threadSweep(long long size)
+{
+	const std::vector<NumaNode> nodes = getNumaNodes();
+	std::vector<int> order, nodeOf;
+	for (int k = 0; k < (int)nodes.size(); k++) {
+		std::cout << "NUMA node " << nodes[k].id << ": " << nodes[k].cpus.size() << " CPUs" << std::endl;
+		for (int cpu : nodes[k].cpus) {
+			order.push_back(cpu);
+			nodeOf.push_back(k);
+		}
+	}
+	std::vector<std::string> placements = { "local" };
+	if (nodes.size() > 1)
+		placements.push_back("remote");
+
+	std::cout << std::setw(8) << "Threads" << std::setw(8) << "Memory" << std::setw(8) << "Kernel" <<
+		std::setw(12) << "Total GB/s" << std::setw(24) << "Per thread min / mean" << std::endl;
+
+	std::vector<ThreadResult> results;
+	for (int nThreads : threadCounts(order.size())) {
+		const std::vector<int> cpus(order.begin(), order.begin() + nThreads);
+		for (const std::string& placement : placements) {
+			std::vector<int> homeCpus = cpus;
+			if (placement == "remote")
+				for (int t = 0; t < nThreads; t++) {
+					const NumaNode& remote = nodes[(nodeOf[t] + 1) % nodes.size()];
+					homeCpus[t] = remote.cpus[t % remote.cpus.size()];
+				}
+
+			for (const BandwidthKernel& kernel : BANDWIDTH_KERNELS) {
+				if (std::find_if(std::begin(THREAD_KERNELS), std::end(THREAD_KERNELS),
+					[&](const char* name) { return std::string(name) == kernel.name; }) == std::end(THREAD_KERNELS))
+					continue;
+				results.push_back(measureThreads(kernel, cpus, homeCpus, placement, size));
+				const ThreadResult& result = results.back();
+				double mean = 0.0;
+				for (double bandwidth : result.perThread)
+					mean += bandwidth / nThreads;
+				std::cout << std::setw(8) << nThreads << std::setw(8) << placement << std::setw(8) << kernel.name <<
+					std::fixed << std::setprecision(2) << std::setw(12) << result.total <<
+					std::setw(14) << *std::min_element(result.perThread.begin(), result.perThread.end()) <<
+					" / " << std::setw(7) << mean << std::endl;
+			}
+		}
+	}
+	return results;
+}
+
+// one line per thread
+void saveThreadsCsv(const std::string& fileName, const std::vector<ThreadResult>& results)
+{
+	std::ofstream file(fileName);
+	file << "kernel,placement,threads,thread,cpu,thread_gbps,total_gbps" << std::endl;
+	for (const ThreadResult& result : results)
+		for (int t = 0; t < (int)result.cpus.size(); t++)
+			file << result.kernel << "," << result.placement << "," << result.cpus.size() << "," << t << "," <<
+				result.cpus[t] << "," << result.perThread[t] << "," << result.total << std::endl;
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#endif
+
+
+// Hardware counters between start() and stop(), read with the Linux
+// perf_event_open. A perf event counts one thread, and the counts of the threads
+// it starts are added to it only when they exit, which the threads of the OpenMP
+// pool never do. So with OpenMP the constructor opens the counters on every
+// thread of the pool (omp_get_max_threads() of them) and stop() sums them;
+// without OpenMP only the calling thread is counted. Each counter is opened on
+// its own, so the kernel may time-share (multiplex) them when there are not
+// enough hardware counters; the values are then scaled by time enabled / time
+// running. A counter that cannot be opened on every thread (other OS,
+// perf_event_paranoid, virtual machine, unknown CPU) is just not available.
+// Construct it once, opening the counters takes a few system calls per thread.
+class PerfCounters {
+
+public:
+
+	enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, VECTOR_INSTRUCTIONS, N_COUNTERS };
+
+private:
+
+	int nThreads;
+	std::vector<int> fds;  // fds[thread * N_COUNTERS + counter]
+	double values[N_COUNTERS];
+	bool counted[N_COUNTERS];
+
+#ifdef __linux__
+	static int openCounter(uint32_t type, uint64_t config) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+
+	// There is no generic event for vector instructions. On Intel it is
+	// FP_ARITH_INST_RETIRED (0xC7) with the umasks of all packed widths (0xFC),
+	// other CPUs need the raw event in PERF_VECTOR_EVENT, e.g. PERF_VECTOR_EVENT=0xfcc7.
+	static uint64_t getVectorEvent() {
+		if (const char* event = std::getenv("PERF_VECTOR_EVENT"))
+			return std::strtoull(event, nullptr, 0);
+		std::ifstream cpuInfo("/proc/cpuinfo");
+		std::string line;
+		while (std::getline(cpuInfo, line))
+			if (line.compare(0, 9, "vendor_id") == 0)
+				return line.find("GenuineIntel") != std::string::npos ? 0xFCC7 : 0;
+		return 0;
+	}
+#endif
+
+public:
+
+	PerfCounters() {
+#ifdef _OPENMP
+		nThreads = omp_get_max_threads();
+#else
+		nThreads = 1;
+#endif
+		fds.assign(nThreads * N_COUNTERS, -1);
+		for (int k = 0; k < N_COUNTERS; k++) {
+			values[k] = 0.0;
+			counted[k] = false;
+		}
+#ifdef __linux__
+		const uint64_t vectorEvent = getVectorEvent();
+		#pragma omp parallel num_threads(nThreads)
+		{
+#ifdef _OPENMP
+			int* threadFds = fds.data() + omp_get_thread_num() * N_COUNTERS;
+#else
+			int* threadFds = fds.data();
+#endif
+			threadFds[CYCLES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+			threadFds[INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+			threadFds[CACHE_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+			threadFds[BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+			if (vectorEvent)
+				threadFds[VECTOR_INSTRUCTIONS] = openCounter(PERF_TYPE_RAW, vectorEvent);
+		}
+#endif
+	}
+
+	~PerfCounters() {
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0)
+				close(fd);
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// an event of another thread can be enabled and read from this one
+	void start() {
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+	}
+
+	void stop() {
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0)
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		for (int k = 0; k < N_COUNTERS; k++) {
+			values[k] = 0.0;
+			counted[k] = true;
+			bool running = false;
+			for (int t = 0; t < nThreads; t++) {
+				const int fd = fds[t * N_COUNTERS + k];
+				uint64_t data[3];  // value, time enabled, time running
+				if (fd < 0 || read(fd, data, sizeof(data)) != sizeof(data)) {
+					counted[k] = false;
+					break;
+				}
+				if (data[2] > 0) {  // a thread that did not run has nothing to add
+					values[k] += (double)data[0] * data[1] / data[2];
+					running = true;
+				}
+			}
+			counted[k] = counted[k] && running;
+		}
+#endif
+	}
+
+	// the last region between start() and stop() was counted
+	bool isAvailable(Counter counter) const { return counted[counter]; }
+	double getValue(Counter counter) const { return values[counter]; }
+
+	static const char* getName(Counter counter) {
+		static const char* names[N_COUNTERS] = {
+			"cycles", "instructions", "cache-misses", "branch-misses", "vector-instructions" };
+		return names[counter];
+	}
+
+	// every counter of the last region divided by n (elements, iterations, ...)
+	void print(std::ostream& out, double n = 1.0) const {
+		bool any = false;
+		for (int k = 0; k < N_COUNTERS; k++)
+			if (counted[k]) {
+				out << (any ? ", " : "") << getName((Counter)k) << " " << values[k] / n;
+				any = true;
+			}
+		if (counted[CYCLES] && counted[INSTRUCTIONS])
+			out << ", IPC " << values[INSTRUCTIONS] / values[CYCLES];
+		if (!any)
+			out << "hardware counters are not available";
+		out << std::endl;
+	}
+
+};
@@ -7,6 +7,7 @@
 #include <tuple>
 
 #include "bmp_reader.h"
+#include "../result_store.h"
 
 
 using IntensityType = float;
@@ -50,6 +51,7 @@ int main(int argc, char** argv) {
 	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 	
 	std::cout << "Time is " << time/1e6 << " sec" << std::endl;		
+	saveResult(argv[0], "average", { time / 1e6 });
 	std::cout << "Avg RGB is " << std::get<0>(avg) << ", " << std::get<1>(avg) << ", " <<
 		std::get<2>(avg) << std::endl;
 	
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#include <limits>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+
+// Lane l of an accumulator always sees channel l % 3 because 48 = lcm(3, 16),
+// so the RGB stream is deinterleaved in the registers and only folded at the end.
+const int N_LANES = 48;  // 3 zmm registers of floats
+const int N_ACCUMULATORS = 4;  // independent sets to hide the add latency
+const int GROUP_SIZE = N_LANES * N_ACCUMULATORS;  // 192 floats = 64 pixels
+const int BLOCK_GROUPS = 256;  // adds per lane before the lanes are folded
+const int BLOCK_SIZE = GROUP_SIZE * BLOCK_GROUPS;
+
+
+// in-place pairwise (tree) summation, error <= ceil(log2(n)) * eps * sum|x|
+float pairwiseSum(float* values, int n)
+{
+	for (int step = 1; step < n; step *= 2)
+		for (int i = 0; i + step < n; i += 2 * step)
+			values[i] += values[i + step];
+	return n > 0 ? values[0] : 0.0f;
+}
+
+// Sums one block of BLOCK_SIZE floats (or less for the tail) into one value per channel.
+// The block starts at a multiple of N_CHANNELS, so element l has channel l % 3.
+void sumBlock(const IntensityType* pixels, int size, float* blockSum)
+{
+	alignas(64) float acc[GROUP_SIZE] = {};
+
+	const int nGroups = size / GROUP_SIZE;
+	for (int g = 0; g < nGroups; g++) {
+		const IntensityType* p = pixels + g * GROUP_SIZE;
+		#pragma omp simd aligned(acc : 64)
+		for (int l = 0; l < GROUP_SIZE; l++)
+			acc[l] += p[l];
+	}
+	for (int l = nGroups * GROUP_SIZE; l < size; l++)
+		acc[l % GROUP_SIZE] += pixels[l];
+
+	// GROUP_SIZE / N_CHANNELS lanes hold each channel
+	const int nChannelLanes = GROUP_SIZE / N_CHANNELS;
+	float lanes[nChannelLanes];
+	for (int k = 0; k < N_CHANNELS; k++) {
+		for (int l = 0; l < nChannelLanes; l++)
+			lanes[l] = acc[l * N_CHANNELS + k];
+		blockSum[k] = pairwiseSum(lanes, nChannelLanes);
+	}
+}
+
+// Error bound of average() relative to the exact sum of each channel (all inputs >= 0):
+// every value goes through at most BLOCK_GROUPS lane adds, log2(GROUP_SIZE / 3) lane folds,
+// log2(nBlocks) block folds and the final division, so |error| <= gamma(n) * sum with
+// n = BLOCK_GROUPS + ceil(log2(GROUP_SIZE / 3)) + ceil(log2(nBlocks)) + 1, gamma(n) = n*eps / (1 - n*eps).
+// A single float accumulator has n = height * width instead.
+double relativeErrorBound(int height, int width)
+{
+	const double eps = std::numeric_limits<float>::epsilon() / 2;
+	const int nBlocks = (height * width * N_CHANNELS + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const double n = BLOCK_GROUPS + std::ceil(std::log2(GROUP_SIZE / N_CHANNELS)) +
+		std::ceil(std::log2(std::max(nBlocks, 1))) + 1;
+	return n * eps / (1 - n * eps);
+}
+
+__declspec(noinline) std::tuple<float, float, float> average(int height, int width,
+	IntensityType* pixels)
+{
+	const int size = height * width * N_CHANNELS;
+	const int nBlocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	std::vector<float> blockSums(nBlocks * N_CHANNELS);
+	for (int b = 0; b < nBlocks; b++)
+		sumBlock(pixels + b * BLOCK_SIZE, std::min(BLOCK_SIZE, size - b * BLOCK_SIZE),
+			blockSums.data() + b * N_CHANNELS);
+
+	float avg[N_CHANNELS];
+	std::vector<float> channelSums(nBlocks);
+	for (int k = 0; k < N_CHANNELS; k++) {
+		for (int b = 0; b < nBlocks; b++)
+			channelSums[b] = blockSums[b * N_CHANNELS + k];
+		avg[k] = pairwiseSum(channelSums.data(), nBlocks) / (height * width);
+	}
+
+	return std::make_tuple(avg[0], avg[1], avg[2]);
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	auto t0 = std::chrono::steady_clock::now();
+	auto avg = average(height, width, pixels.data());
+	auto t1 = std::chrono::steady_clock::now();
+	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+	// reference in double, pixel values are integers so it is exact
+	double reference[N_CHANNELS] = {};
+	for (int i = 0; i < height * width; i++)
+		for (int k = 0; k < N_CHANNELS; k++)
+			reference[k] += pixels[N_CHANNELS * i + k];
+	float result[N_CHANNELS] = { std::get<0>(avg), std::get<1>(avg), std::get<2>(avg) };
+	double maxError = 0.0;
+	for (int k = 0; k < N_CHANNELS; k++) {
+		reference[k] /= (double)height * width;
+		if (reference[k] > 0)
+			maxError = std::max(maxError, std::abs(result[k] - reference[k]) / reference[k]);
+	}
+
+	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	std::cout << "Throughput is " << pixels.size() * sizeof(IntensityType) / (time * 1e3) << " GB/s" << std::endl;
+	saveResult(argv[0], "average", { time / 1e6 });
+	std::cout << "Avg RGB is " << std::get<0>(avg) << ", " << std::get<1>(avg) << ", " <<
+		std::get<2>(avg) << std::endl;
+	std::cout << "Relative error is " << maxError << ", bound is " <<
+		relativeErrorBound(height, width) << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#include <cstdint>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = uint8_t;  // raw bytes, no conversion to float
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+
+// Lane l always sees channel l % 3 (192 = 3 * 64 bytes). Bytes are widened into
+// 16-bit lanes (vpmovzxbw + vpaddw, 32 lanes per zmm) and the lanes are flushed
+// into 64-bit totals before they can overflow: 256 * 255 < 2^16.
+const int N_LANES = 192;
+const int FLUSH_GROUPS = 256;
+
+
+// exact per-channel sums of height * width interleaved RGB pixels
+__declspec(noinline) std::tuple<uint64_t, uint64_t, uint64_t> sum(int height, int width,
+	const IntensityType* pixels)
+{
+	const long long size = (long long)height * width * N_CHANNELS;
+	const long long nGroups = size / N_LANES;
+
+	alignas(64) uint64_t total[N_LANES] = {};
+	alignas(64) uint16_t acc[N_LANES];
+
+	for (long long g0 = 0; g0 < nGroups; g0 += FLUSH_GROUPS) {
+		const long long g1 = std::min(g0 + FLUSH_GROUPS, nGroups);
+
+		#pragma omp simd aligned(acc : 64)
+		for (int l = 0; l < N_LANES; l++)
+			acc[l] = 0;
+
+		for (long long g = g0; g < g1; g++) {
+			const IntensityType* p = pixels + g * N_LANES;
+			#pragma omp simd aligned(acc : 64)
+			for (int l = 0; l < N_LANES; l++)
+				acc[l] += p[l];
+		}
+
+		#pragma omp simd aligned(acc, total : 64)
+		for (int l = 0; l < N_LANES; l++)
+			total[l] += acc[l];
+	}
+
+	for (long long l = nGroups * N_LANES; l < size; l++)
+		total[l % N_LANES] += pixels[l];
+
+	uint64_t channelSum[N_CHANNELS] = {};
+	for (int l = 0; l < N_LANES; l++)
+		channelSum[l % N_CHANNELS] += total[l];
+
+	return std::make_tuple(channelSum[0], channelSum[1], channelSum[2]);
+}
+
+__declspec(noinline) std::tuple<float, float, float> average(int height, int width,
+	const IntensityType* pixels)
+{
+	auto s = sum(height, width, pixels);
+	const double count = (double)height * width;
+	return std::make_tuple((float)(std::get<0>(s) / count), (float)(std::get<1>(s) / count),
+		(float)(std::get<2>(s) / count));
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	auto t0 = std::chrono::steady_clock::now();
+	auto avg = average(height, width, pixels.data());
+	auto t1 = std::chrono::steady_clock::now();
+	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	std::cout << "Throughput is " << pixels.size() * sizeof(IntensityType) / (time * 1e3) << " GB/s" << std::endl;
+	saveResult(argv[0], "average", { time / 1e6 });
+	std::cout << "Avg RGB is " << std::get<0>(avg) << ", " << std::get<1>(avg) << ", " <<
+		std::get<2>(avg) << std::endl;
+
+	return 0;
+}
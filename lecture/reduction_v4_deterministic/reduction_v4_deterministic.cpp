@@ -0,0 +1,236 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = float;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+
+// The split into blocks and the combine tree depend only on the number of pixels,
+// never on the number of threads, so every result is bitwise reproducible.
+const int BLOCK_PIXELS = 16384;
+const int N_LANES = 48;  // lane l always sees channel l % 3
+
+
+struct Channels {
+	float value[N_CHANNELS];
+};
+
+// An operator provides
+//   Value identity() const;
+//   Value reduceBlock(const IntensityType* pixels, int nPixels) const;  // fixed order inside a block
+//   Value combine(const Value& a, const Value& b) const;  // associative
+
+struct SumOp {
+	using Value = Channels;
+
+	Value identity() const { return Value{ { 0.0f, 0.0f, 0.0f } }; }
+
+	Value reduceBlock(const IntensityType* pixels, int nPixels) const {
+		alignas(64) float acc[N_LANES] = {};
+		const int size = nPixels * N_CHANNELS, nGroups = size / N_LANES;
+		for (int g = 0; g < nGroups; g++) {
+			#pragma omp simd aligned(acc : 64)
+			for (int l = 0; l < N_LANES; l++)
+				acc[l] += pixels[g * N_LANES + l];
+		}
+		for (int l = nGroups * N_LANES; l < size; l++)
+			acc[l % N_LANES] += pixels[l];
+
+		Value res = identity();
+		for (int l = 0; l < N_LANES; l++)
+			res.value[l % N_CHANNELS] += acc[l];
+		return res;
+	}
+
+	Value combine(const Value& a, const Value& b) const {
+		Value res;
+		for (int k = 0; k < N_CHANNELS; k++)
+			res.value[k] = a.value[k] + b.value[k];
+		return res;
+	}
+};
+
+struct MinOp {
+	using Value = Channels;
+
+	Value identity() const {
+		const float inf = std::numeric_limits<float>::infinity();
+		return Value{ { inf, inf, inf } };
+	}
+
+	Value reduceBlock(const IntensityType* pixels, int nPixels) const {
+		Value res = identity();
+		for (int i = 0; i < nPixels; i++)
+			for (int k = 0; k < N_CHANNELS; k++)
+				res.value[k] = std::min(res.value[k], pixels[i * N_CHANNELS + k]);
+		return res;
+	}
+
+	Value combine(const Value& a, const Value& b) const {
+		Value res;
+		for (int k = 0; k < N_CHANNELS; k++)
+			res.value[k] = std::min(a.value[k], b.value[k]);
+		return res;
+	}
+};
+
+struct MaxOp {
+	using Value = Channels;
+
+	Value identity() const {
+		const float inf = std::numeric_limits<float>::infinity();
+		return Value{ { -inf, -inf, -inf } };
+	}
+
+	Value reduceBlock(const IntensityType* pixels, int nPixels) const {
+		Value res = identity();
+		for (int i = 0; i < nPixels; i++)
+			for (int k = 0; k < N_CHANNELS; k++)
+				res.value[k] = std::max(res.value[k], pixels[i * N_CHANNELS + k]);
+		return res;
+	}
+
+	Value combine(const Value& a, const Value& b) const {
+		Value res;
+		for (int k = 0; k < N_CHANNELS; k++)
+			res.value[k] = std::max(a.value[k], b.value[k]);
+		return res;
+	}
+};
+
+// Custom operator from an identity value, a per-pixel map and an associative combine,
+// pixels of a block are folded left to right.
+template <class Value_, class Map, class Combine>
+struct MapReduceOp {
+	using Value = Value_;
+
+	Value init;
+	Map map;  // Value map(const IntensityType* pixel)
+	Combine combineFunc;  // Value combine(const Value&, const Value&)
+
+	Value identity() const { return init; }
+
+	Value reduceBlock(const IntensityType* pixels, int nPixels) const {
+		Value res = init;
+		for (int i = 0; i < nPixels; i++)
+			res = combineFunc(res, map(pixels + i * N_CHANNELS));
+		return res;
+	}
+
+	Value combine(const Value& a, const Value& b) const { return combineFunc(a, b); }
+};
+
+template <class Value, class Map, class Combine>
+MapReduceOp<Value, Map, Combine> makeOp(const Value& init, Map map, Combine combine)
+{
+	return MapReduceOp<Value, Map, Combine>{ init, map, combine };
+}
+
+
+template <class Op>
+__declspec(noinline) typename Op::Value reduce(int height, int width,
+	const IntensityType* pixels, const Op& op)
+{
+	using Value = typename Op::Value;
+	const int nPixels = height * width;
+	const int nBlocks = (nPixels + BLOCK_PIXELS - 1) / BLOCK_PIXELS;
+	if (nBlocks == 0)
+		return op.identity();
+
+	std::vector<Value> partial(nBlocks);
+
+	#pragma omp parallel for schedule(static)
+	for (int b = 0; b < nBlocks; b++) {
+		const int begin = b * BLOCK_PIXELS;
+		partial[b] = op.reduceBlock(pixels + begin * N_CHANNELS, std::min(BLOCK_PIXELS, nPixels - begin));
+	}
+
+	// pairwise tree: level s combines blocks b and b + s for b % (2s) == 0
+	for (int step = 1; step < nBlocks; step *= 2) {
+		#pragma omp parallel for schedule(static)
+		for (int b = 0; b < nBlocks - step; b += 2 * step)
+			partial[b] = op.combine(partial[b], partial[b + step]);
+	}
+
+	return partial[0];
+}
+
+Channels average(int height, int width, const IntensityType* pixels)
+{
+	Channels res = reduce(height, width, pixels, SumOp());
+	for (int k = 0; k < N_CHANNELS; k++)
+		res.value[k] /= height * width;
+	return res;
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	// custom operator: sum of squared intensities of every channel
+	auto squaresOp = makeOp(SumOp().identity(),
+		[](const IntensityType* pixel) {
+			Channels res;
+			for (int k = 0; k < N_CHANNELS; k++)
+				res.value[k] = pixel[k] * pixel[k];
+			return res;
+		},
+		[](const Channels& a, const Channels& b) { return SumOp().combine(a, b); });
+
+	const int maxThreads = omp_get_max_threads();
+	Channels reference[4];
+	bool identical = true;
+
+	for (int nThreads = 1; nThreads <= maxThreads; nThreads++) {
+		omp_set_num_threads(nThreads);
+
+		auto t0 = std::chrono::steady_clock::now();
+		Channels result[4] = {
+			average(height, width, pixels.data()),
+			reduce(height, width, pixels.data(), MinOp()),
+			reduce(height, width, pixels.data(), MaxOp()),
+			reduce(height, width, pixels.data(), squaresOp)
+		};
+		auto t1 = std::chrono::steady_clock::now();
+		float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+		if (nThreads == 1)
+			std::memcpy(reference, result, sizeof(result));
+		const bool same = std::memcmp(reference, result, sizeof(result)) == 0;
+		identical = identical && same;
+
+		std::cout << "Threads " << nThreads << ": time is " << time/1e6 << " sec, " <<
+			(same ? "bitwise identical" : "MISMATCH") << std::endl;
+		saveResult(argv[0], "reduce " + std::to_string(nThreads) + " threads", { time / 1e6 });
+	}
+
+	std::cout << "Avg RGB is " << reference[0].value[0] << ", " << reference[0].value[1] << ", " <<
+		reference[0].value[2] << std::endl;
+	std::cout << "Min RGB is " << reference[1].value[0] << ", " << reference[1].value[1] << ", " <<
+		reference[1].value[2] << std::endl;
+	std::cout << "Max RGB is " << reference[2].value[0] << ", " << reference[2].value[1] << ", " <<
+		reference[2].value[2] << std::endl;
+	if (!identical)
+		std::cout << "ERROR: RESULTS DEPEND ON THE NUMBER OF THREADS" << std::endl;
+
+	return 0;
+}
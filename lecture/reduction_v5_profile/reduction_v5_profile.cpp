@@ -0,0 +1,176 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+#include <cstdint>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = uint8_t;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int N_BINS = 256;
+
+// The image is streamed once in chunks that fit into L1: a SIMD loop collects the
+// sums, squares, min and max of a chunk, then the histogram loop rereads it from cache.
+const int N_LANES = 48;  // lane l always sees channel l % 3
+const int CHUNK_GROUPS = 64;  // 64 * 255^2 fits into the 32-bit square lanes
+const int CHUNK_SIZE = N_LANES * CHUNK_GROUPS;  // 3072 bytes
+
+
+struct ChannelStatistics {
+	uint64_t count = 0;
+	double mean = 0.0, m2 = 0.0;  // m2 is the sum of squared deviations from the mean
+	int min = MAX_INTENSITY, max = MIN_INTENSITY;
+	uint64_t histogram[N_BINS] = {};
+
+	double variance() const { return count ? m2 / count : 0.0; }
+	double stddev() const { return std::sqrt(variance()); }
+
+	// smallest intensity with at least p * count pixels at or below it, p in [0, 1]
+	int percentile(double p) const {
+		const double target = p * count;
+		uint64_t cdf = 0;
+		for (int v = 0; v < N_BINS; v++) {
+			cdf += histogram[v];
+			if (cdf > 0 && cdf >= target)
+				return v;
+		}
+		return MAX_INTENSITY;
+	}
+
+	// Chan et al. pairwise update of (count, mean, m2), the parallel form of Welford's algorithm
+	void merge(const ChannelStatistics& other) {
+		if (other.count == 0) return;
+		const uint64_t n = count + other.count;
+		const double delta = other.mean - mean;
+		mean += delta * other.count / n;
+		m2 += other.m2 + delta * delta * ((double)count * other.count / n);
+		count = n;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+		for (int v = 0; v < N_BINS; v++)
+			histogram[v] += other.histogram[v];
+	}
+};
+
+struct ImageStatistics {
+	ChannelStatistics channel[N_CHANNELS];
+};
+
+
+// Partial statistics of size interleaved bytes starting at a pixel boundary.
+void profileRange(const IntensityType* pixels, long long size, ImageStatistics& stats)
+{
+	uint64_t sum[N_CHANNELS] = {}, sumSq[N_CHANNELS] = {};
+
+	for (long long begin = 0; begin < size; begin += CHUNK_SIZE) {
+		const IntensityType* p = pixels + begin;
+		const int chunk = (int)std::min((long long)CHUNK_SIZE, size - begin);
+		const int nGroups = chunk / N_LANES;
+
+		alignas(64) uint32_t laneSum[N_LANES] = {}, laneSumSq[N_LANES] = {};
+		alignas(64) uint8_t laneMin[N_LANES], laneMax[N_LANES];
+		for (int l = 0; l < N_LANES; l++) {
+			laneMin[l] = MAX_INTENSITY;
+			laneMax[l] = MIN_INTENSITY;
+		}
+
+		for (int g = 0; g < nGroups; g++) {
+			#pragma omp simd aligned(laneSum, laneSumSq, laneMin, laneMax : 64)
+			for (int l = 0; l < N_LANES; l++) {
+				const uint32_t x = p[g * N_LANES + l];
+				laneSum[l] += x;
+				laneSumSq[l] += x * x;
+				laneMin[l] = std::min(laneMin[l], (uint8_t)x);
+				laneMax[l] = std::max(laneMax[l], (uint8_t)x);
+			}
+		}
+		for (int l = nGroups * N_LANES; l < chunk; l++) {
+			const uint32_t x = p[l];
+			laneSum[l % N_LANES] += x;
+			laneSumSq[l % N_LANES] += x * x;
+			laneMin[l % N_LANES] = std::min(laneMin[l % N_LANES], (uint8_t)x);
+			laneMax[l % N_LANES] = std::max(laneMax[l % N_LANES], (uint8_t)x);
+		}
+
+		for (int l = 0; l < N_LANES; l++) {
+			ChannelStatistics& s = stats.channel[l % N_CHANNELS];
+			sum[l % N_CHANNELS] += laneSum[l];
+			sumSq[l % N_CHANNELS] += laneSumSq[l];
+			s.min = std::min(s.min, (int)laneMin[l]);
+			s.max = std::max(s.max, (int)laneMax[l]);
+		}
+
+		// the chunk is still in L1
+		for (int i = 0; i < chunk; i += N_CHANNELS)
+			for (int k = 0; k < N_CHANNELS; k++)
+				stats.channel[k].histogram[p[i + k]]++;
+	}
+
+	// integer sums are exact, convert once to (count, mean, m2)
+	for (int k = 0; k < N_CHANNELS; k++) {
+		ChannelStatistics& s = stats.channel[k];
+		s.count = size / N_CHANNELS;
+		if (s.count == 0) continue;
+		s.mean = (double)sum[k] / s.count;
+		s.m2 = (double)sumSq[k] - (double)sum[k] * s.mean;
+	}
+}
+
+__declspec(noinline) ImageStatistics profile(int height, int width,
+	const IntensityType* pixels)
+{
+	const long long nPixels = (long long)height * width;
+	std::vector<ImageStatistics> partial(omp_get_max_threads());
+
+	#pragma omp parallel
+	{
+		const int nThreads = omp_get_num_threads(), thread = omp_get_thread_num();
+		const long long begin = nPixels * thread / nThreads, end = nPixels * (thread + 1) / nThreads;
+		profileRange(pixels + begin * N_CHANNELS, (end - begin) * N_CHANNELS, partial[thread]);
+	}
+
+	ImageStatistics stats;
+	for (const ImageStatistics& p : partial)
+		for (int k = 0; k < N_CHANNELS; k++)
+			stats.channel[k].merge(p.channel[k]);
+	return stats;
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	auto t0 = std::chrono::steady_clock::now();
+	ImageStatistics stats = profile(height, width, pixels.data());
+	auto t1 = std::chrono::steady_clock::now();
+	float time = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+	std::cout << "Time is " << time/1e6 << " sec" << std::endl;
+	std::cout << "Throughput is " << pixels.size() * sizeof(IntensityType) / (time * 1e3) << " GB/s" << std::endl;
+	saveResult(argv[0], "profile", { time / 1e6 });
+
+	const char* names[N_CHANNELS] = { "R", "G", "B" };
+	for (int k = 0; k < N_CHANNELS; k++) {
+		const ChannelStatistics& s = stats.channel[k];
+		std::cout << names[k] << ": count " << s.count << ", mean " << s.mean << ", stddev " << s.stddev() <<
+			", min " << s.min << ", max " << s.max << ", p1 " << s.percentile(0.01) <<
+			", median " << s.percentile(0.5) << ", p99 " << s.percentile(0.99) << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,237 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+#include <tuple>
+#include <cstdint>
+#include <immintrin.h>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+
+
+using IntensityType = uint8_t;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const int N_LANES = 192;  // lane l always sees channel l % 3
+const int FLUSH_GROUPS = 65536;  // 65536 * 255 < 2^32
+const int ALIGNMENT = 64;  // images start at cache line boundaries
+const int THUMBNAIL_SIZE = 256;
+const int N_IMAGES = 1024;
+
+
+// Many small images packed back to back into one buffer.
+class ImageBatch {
+
+	IntensityType* arena;  // ALIGNMENT-aligned
+	long long capacity, used = 0;
+	std::vector<long long> offsets;
+	std::vector<int> heights, widths;
+
+public:
+
+	// room for nImages images of nBytes in total
+	ImageBatch(int nImages, long long nBytes) :
+		capacity(nBytes + (long long)nImages * ALIGNMENT)
+	{
+		arena = (IntensityType*)_mm_malloc(capacity, ALIGNMENT);
+		offsets.reserve(nImages);
+		heights.reserve(nImages);
+		widths.reserve(nImages);
+	}
+
+	~ImageBatch() { _mm_free(arena); }
+
+	ImageBatch(const ImageBatch&) = delete;
+	ImageBatch& operator=(const ImageBatch&) = delete;
+
+	// returns false if the image does not fit
+	bool add(int height, int width, const IntensityType* pixels) {
+		const long long size = (long long)height * width * N_CHANNELS;
+		const long long offset = (used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		if (offset + size > capacity)
+			return false;
+		std::copy(pixels, pixels + size, arena + offset);
+		used = offset + size;
+		offsets.push_back(offset);
+		heights.push_back(height);
+		widths.push_back(width);
+		return true;
+	}
+
+	int getSize() const { return offsets.size(); }
+	int getHeight(int image) const { return heights[image]; }
+	int getWidth(int image) const { return widths[image]; }
+	const IntensityType* getPixels(int image) const { return arena + offsets[image]; }
+
+};
+
+
+// exact per-channel sums of size interleaved bytes: N_LANES 32-bit lanes (a multiple
+// of 3, so lane l keeps channel l % 3) add one byte per group, a lane gets at most
+// FLUSH_GROUPS * 255 < 2^32 before it goes to its 64-bit total
+void sumChannels(long long size, const IntensityType* pixels, uint64_t* channelSum)
+{
+	const long long nGroups = size / N_LANES;
+	alignas(64) uint64_t total[N_LANES] = {};
+	alignas(64) uint32_t acc[N_LANES];
+
+	for (long long g0 = 0; g0 < nGroups; g0 += FLUSH_GROUPS) {
+		const long long g1 = std::min(g0 + FLUSH_GROUPS, nGroups);
+		#pragma omp simd aligned(acc : 64)
+		for (int l = 0; l < N_LANES; l++)
+			acc[l] = 0;
+		for (long long g = g0; g < g1; g++) {
+			const IntensityType* p = pixels + g * N_LANES;
+			#pragma omp simd aligned(acc : 64)
+			for (int l = 0; l < N_LANES; l++)
+				acc[l] += p[l];
+		}
+		#pragma omp simd aligned(acc, total : 64)
+		for (int l = 0; l < N_LANES; l++)
+			total[l] += acc[l];
+	}
+	for (long long l = nGroups * N_LANES; l < size; l++)
+		total[l % N_LANES] += pixels[l];
+
+	for (int k = 0; k < N_CHANNELS; k++)
+		channelSum[k] = 0;
+	for (int l = 0; l < N_LANES; l++)
+		channelSum[l % N_CHANNELS] += total[l];
+}
+
+__declspec(noinline) std::tuple<float, float, float> average(int height, int width,
+	const IntensityType* pixels)
+{
+	uint64_t sum[N_CHANNELS];
+	sumChannels((long long)height * width * N_CHANNELS, pixels, sum);
+	const double count = (double)height * width;
+	return std::make_tuple((float)(sum[0] / count), (float)(sum[1] / count), (float)(sum[2] / count));
+}
+
+// result[image * N_CHANNELS + k] is the mean of channel k, images are spread over the threads
+__declspec(noinline) void averageBatch(const ImageBatch& batch, float* result)
+{
+	const int nImages = batch.getSize();
+
+	#pragma omp parallel for schedule(dynamic, 4)
+	for (int image = 0; image < nImages; image++) {
+		const int height = batch.getHeight(image), width = batch.getWidth(image);
+		uint64_t sum[N_CHANNELS];
+		sumChannels((long long)height * width * N_CHANNELS, batch.getPixels(image), sum);
+		for (int k = 0; k < N_CHANNELS; k++)
+			result[image * N_CHANNELS + k] = (float)(sum[k] / ((double)height * width));
+	}
+}
+
+// the same as average, the threads sum equal blocks of the image, as many blocks as
+// the batch has images
+__declspec(noinline) std::tuple<float, float, float> averageParallel(int height, int width,
+	const IntensityType* pixels, int nBlocks)
+{
+	const long long size = (long long)height * width * N_CHANNELS;
+	const long long blockSize = (size / nBlocks + N_LANES - 1) / N_LANES * N_LANES;  // starts at channel 0
+	uint64_t sum[N_CHANNELS] = {};
+
+	#pragma omp parallel for schedule(dynamic, 4)
+	for (int block = 0; block < nBlocks; block++) {
+		const long long begin = std::min(block * blockSize, size), end = std::min(begin + blockSize, size);
+		uint64_t partial[N_CHANNELS];
+		sumChannels(end - begin, pixels + begin, partial);
+		for (int k = 0; k < N_CHANNELS; k++)
+			#pragma omp atomic
+			sum[k] += partial[k];
+	}
+
+	const double count = (double)height * width;
+	return std::make_tuple((float)(sum[0] / count), (float)(sum[1] / count), (float)(sum[2] / count));
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	if (!reader.open("photo.bmp")) {
+		std::cout << "Error when reading" << std::endl;
+		return 0;
+	}
+
+	std::vector<IntensityType> pixels = reader.getRGBPixels<IntensityType>();
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	// thumbnails are cut from the photo, cycling over it
+	const int size = std::min(THUMBNAIL_SIZE, std::min(height, width));
+	const int nRows = height / size, nCols = width / size;
+	const long long imageSize = (long long)size * size * N_CHANNELS;
+
+	std::vector<std::vector<IntensityType>> images(N_IMAGES, std::vector<IntensityType>(imageSize));
+	ImageBatch batch(N_IMAGES, N_IMAGES * imageSize);
+	for (int image = 0; image < N_IMAGES; image++) {
+		const int y = (image / nCols) % nRows * size, x = image % nCols * size;
+		for (int i = 0; i < size; i++)
+			std::copy_n(pixels.begin() + ((y + i) * width + x) * N_CHANNELS, size * N_CHANNELS,
+				images[image].begin() + i * size * N_CHANNELS);
+		batch.add(size, size, images[image].data());
+	}
+	std::vector<IntensityType> large(N_IMAGES * imageSize);
+	for (int image = 0; image < N_IMAGES; image++)
+		std::copy(images[image].begin(), images[image].end(), large.begin() + image * imageSize);
+
+	std::vector<float> separate(N_IMAGES * N_CHANNELS), batched(N_IMAGES * N_CHANNELS);
+	std::tuple<float, float, float> avg;
+
+	// the first pass warms up the caches, the pages and the threads, the second is timed
+	std::chrono::steady_clock::time_point t0, t1, t2, t3;
+	for (int pass = 0; pass < 2; pass++) {
+		t0 = std::chrono::steady_clock::now();
+		for (int image = 0; image < N_IMAGES; image++) {
+			auto imageAvg = average(size, size, images[image].data());
+			separate[image * N_CHANNELS] = std::get<0>(imageAvg);
+			separate[image * N_CHANNELS + 1] = std::get<1>(imageAvg);
+			separate[image * N_CHANNELS + 2] = std::get<2>(imageAvg);
+		}
+		t1 = std::chrono::steady_clock::now();
+		averageBatch(batch, batched.data());
+		t2 = std::chrono::steady_clock::now();
+		avg = averageParallel(N_IMAGES * size, size, large.data(), N_IMAGES);
+		t3 = std::chrono::steady_clock::now();
+	}
+
+	const float bytes = N_IMAGES * imageSize;
+	float timeSeparate = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+	float timeBatch = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+	float timeLarge = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
+
+	std::cout << N_IMAGES << " images of " << size << "x" << size << std::endl;
+	std::cout << "One call per image: time is " << timeSeparate/1e6 << " sec, " <<
+		bytes / (timeSeparate * 1e3) << " GB/s" << std::endl;
+	std::cout << "Batch: time is " << timeBatch/1e6 << " sec, " <<
+		bytes / (timeBatch * 1e3) << " GB/s" << std::endl;
+	std::cout << "One large image, parallel: time is " << timeLarge/1e6 << " sec, " <<
+		bytes / (timeLarge * 1e3) << " GB/s" << std::endl;
+	saveResult(argv[0], "average", { timeSeparate / 1e6 });
+	saveResult(argv[0], "averageBatch", { timeBatch / 1e6 });
+	saveResult(argv[0], "averageParallel", { timeLarge / 1e6 });
+	std::cout << "Avg RGB of the first image is " << batched[0] << ", " << batched[1] << ", " <<
+		batched[2] << std::endl;
+	std::cout << "Avg RGB of all images is " << std::get<0>(avg) << ", " << std::get<1>(avg) << ", " <<
+		std::get<2>(avg) << std::endl;
+
+	// the images have the same size, so the mean of their means is the mean of the large one
+	double meanOfMeans[N_CHANNELS] = {};
+	for (int image = 0; image < N_IMAGES; image++)
+		for (int k = 0; k < N_CHANNELS; k++)
+			meanOfMeans[k] += batched[image * N_CHANNELS + k] / (double)N_IMAGES;
+	const float largeMean[N_CHANNELS] = { std::get<0>(avg), std::get<1>(avg), std::get<2>(avg) };
+	bool sameLarge = true;
+	for (int k = 0; k < N_CHANNELS; k++)
+		sameLarge = sameLarge && std::fabs(meanOfMeans[k] - largeMean[k]) < 1e-3;
+
+	if (separate != batched || !sameLarge)
+		std::cout << "ERROR: WRONG RESULT!!!" << std::endl;
+
+	return 0;
+}
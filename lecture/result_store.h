@@ -0,0 +1,110 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// run.bat and CMake pass the build description
+#ifndef BENCH_FLAGS
+#define BENCH_FLAGS "unknown"
+#endif
+#ifndef BENCH_GIT_HASH
+#define BENCH_GIT_HASH "unknown"
+#endif
+// tells apart builds of the same git hash with different uncommitted edits;
+// run.bat passes one id for all its programs, otherwise it is the compile time
+#ifndef BENCH_BUILD_ID
+#define BENCH_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+
+const char* const DEFAULT_RESULTS_FILE = "results.jsonl";  // BENCH_RESULTS overrides it
+
+
+inline std::string getCpuName()
+{
+	unsigned int brand[12] = {};
+	for (unsigned int i = 0; i < 3; i++) {
+#ifdef _WIN32
+		__cpuid((int*)brand + 4 * i, 0x80000002 + i);
+#else
+		__get_cpuid(0x80000002 + i, brand + 4 * i, brand + 4 * i + 1, brand + 4 * i + 2, brand + 4 * i + 3);
+#endif
+	}
+	std::string name((const char*)brand, strnlen((const char*)brand, sizeof(brand)));
+	name.erase(0, name.find_first_not_of(' '));
+	return name.empty() ? "unknown" : name;
+}
+
+inline std::string getCompilerName()
+{
+	std::stringstream name;
+#if defined(__INTEL_COMPILER)
+	name << "Intel " << __INTEL_COMPILER << "." << __INTEL_COMPILER_UPDATE;
+#elif defined(__INTEL_LLVM_COMPILER)
+	name << "Intel oneAPI " << __INTEL_LLVM_COMPILER;
+#elif defined(__clang__)
+	name << "clang " << __clang_version__;
+#elif defined(__GNUC__)
+	name << "gcc " << __VERSION__;
+#elif defined(_MSC_VER)
+	name << "MSVC " << _MSC_VER;
+#else
+	name << "unknown";
+#endif
+	return name.str();
+}
+
+// "dir\gamma_rgb_v7_zmm.exe" -> "gamma_rgb_v7_zmm"
+inline std::string getProgramName(const std::string& path)
+{
+	std::string name = path.substr(path.find_last_of("/\\") + 1);
+	if (name.size() > 4 && name.compare(name.size() - 4, 4, ".exe") == 0)
+		name.resize(name.size() - 4);
+	return name;
+}
+
+inline std::string toJsonString(const std::string& value)
+{
+	std::string escaped = "\"";
+	for (char c : value) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped + "\"";
+}
+
+// Appends one line with the samples (seconds) of a kernel and the description of
+// the machine and the build to the results file. compare_results reads them.
+inline void saveResult(const std::string& program, const std::string& kernel, const std::vector<double>& samples)
+{
+	const char* fileName = std::getenv("BENCH_RESULTS");
+	std::ofstream file(fileName ? fileName : DEFAULT_RESULTS_FILE, std::ios::app);
+
+	char date[32];
+	const std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	file << std::setprecision(9);
+	file << "{\"benchmark\": " << toJsonString(getProgramName(program)) <<
+		", \"kernel\": " << toJsonString(kernel) << ", \"samples\": [";
+	for (size_t s = 0; s < samples.size(); s++)
+		file << (s > 0 ? ", " : "") << samples[s];
+	file << "], \"cpu\": " << toJsonString(getCpuName()) <<
+		", \"compiler\": " << toJsonString(getCompilerName()) <<
+		", \"flags\": " << toJsonString(BENCH_FLAGS) <<
+		", \"git\": " << toJsonString(BENCH_GIT_HASH) <<
+		", \"build_id\": " << toJsonString(BENCH_BUILD_ID) <<
+		", \"date\": " << toJsonString(date) << "}" << std::endl;
+}
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+
+const int VECTOR_BYTES = 64;  // zmm
+const int N_FMA_ACCUMULATORS = 12;  // 2 FMA ports x 4 cycles latency, with some spare
+const long long FMA_ITERATIONS = 1 << 24;
+const long long FALLBACK_CACHE_SIZE = 12 << 10;  // bytes, fits in L1
+const long long FALLBACK_DRAM_SIZE = 3 * 64LL << 20;  // bytes, far beyond the L3
+const long long TRIAL_TRAFFIC = 256 << 20;
+const int N_TRIALS = 5;
+const char* DEFAULT_BANDWIDTH_FILE = "memory_benchmark/memory_benchmark_bandwidth.csv";
+
+
+// Kernels of the course with the traffic and the work of one element, counted
+// by hand from the code. Bytes are what the loop reads and writes (no
+// write-allocate), a multiplication or an addition is one FLOP and an FMA is two.
+struct RooflineKernel {
+	const char* name;
+	bool isDouble;
+	double bytes, flops;  // per element
+};
+
+const RooflineKernel ROOFLINE_KERNELS[] = {
+	// gamma_rgb: float in, float out; FACTOR * pow(x, GAMMA) and the clamp, pow is
+	// about 22 FLOPs of the log and exp polynomials in the vector math library
+	{ "gamma", false, 8, 25 },
+	// integral_v2: float, in place, pixel - upleft + up + left; the row above and the
+	// pixel to the left are in the cache, so the pixel is read and written once
+	{ "integral", false, 8, 3 },
+	// reduction_v1: one float and one addition
+	{ "reduction", false, 4, 1 },
+	// practice Model::update: r and v read and written; 4 Lorentz forces (cross
+	// product, division, field) and the RK4 combinations of k1..k4
+	{ "particle RK4", true, 96, 150 }
+};
+
+
+// a * acc + b on N_FMA_ACCUMULATORS independent vectors, it converges to b / (1 - a)
+template <class T>
+__declspec(noinline) T fmaKernel(long long iterations, T a, T b)
+{
+	const int nLanes = N_FMA_ACCUMULATORS * VECTOR_BYTES / sizeof(T);
+	alignas(64) T acc[nLanes];
+	for (int l = 0; l < nLanes; l++)
+		acc[l] = (T)l / nLanes;
+
+	for (long long it = 0; it < iterations; it++)
+		#pragma omp simd aligned(acc : 64)
+		for (int l = 0; l < nLanes; l++)
+			acc[l] = a * acc[l] + b;
+
+	T sum = 0;
+	for (int l = 0; l < nLanes; l++)
+		sum += acc[l];
+	return sum;
+}
+
+// GFLOP/s of one core, the best of N_TRIALS
+template <class T>
+double measurePeakFlops()
+{
+	const double flops = 2.0 * N_FMA_ACCUMULATORS * VECTOR_BYTES / sizeof(T) * FMA_ITERATIONS;
+	double best = 0.0;
+	volatile T sink = 0;
+	for (int trial = 0; trial < N_TRIALS; trial++) {
+		auto t0 = std::chrono::steady_clock::now();
+		sink = sink + fmaKernel<T>(FMA_ITERATIONS, (T)0.999, (T)0.001);
+		auto t1 = std::chrono::steady_clock::now();
+		best = std::max(best, flops / std::chrono::duration<double>(t1 - t0).count() / 1e9);
+	}
+	return best;
+}
+
+__declspec(noinline) void triad(long long n, const float* x, const float* y, float* z)
+{
+	#pragma ivdep
+	for (long long i = 0; i < n; i++)
+		z[i] = x[i] + 3.0f * y[i];
+}
+
+// triad GB/s over arrays of the given total size, used if there is no
+// memory_benchmark output
+double measureTriadBandwidth(long long size)
+{
+	const long long n = size / 3 / sizeof(float);
+	const long long repeats = std::max(1LL, TRIAL_TRAFFIC / size);
+	std::vector<float> x(n), y(n), z(n);
+	triad(n, x.data(), y.data(), z.data());
+	double best = 0.0;
+	for (int trial = 0; trial < N_TRIALS; trial++) {
+		auto t0 = std::chrono::steady_clock::now();
+		for (long long r = 0; r < repeats; r++)
+			triad(n, x.data(), y.data(), z.data());
+		auto t1 = std::chrono::steady_clock::now();
+		best = std::max(best, 3.0 * n * sizeof(float) * repeats / std::chrono::duration<double>(t1 - t0).count() / 1e9);
+	}
+	return best;
+}
+
+// Triad bandwidth from memory_benchmark bandwidth: the best value over all sizes
+// is the L1 roof, the value at the largest size is the DRAM roof.
+bool readBandwidth(const std::string& fileName, double& cacheBandwidth, double& dramBandwidth)
+{
+	std::ifstream file(fileName);
+	std::string line;
+	if (!std::getline(file, line))  // header
+		return false;
+
+	long long largest = 0;
+	cacheBandwidth = dramBandwidth = 0.0;
+	while (std::getline(file, line)) {
+		std::stringstream stream(line);
+		std::string kernel, size, best;
+		std::getline(stream, kernel, ',');
+		std::getline(stream, size, ',');
+		std::getline(stream, best, ',');
+		if (kernel != "triad")
+			continue;
+		cacheBandwidth = std::max(cacheBandwidth, std::stod(best));
+		if (std::stoll(size) >= largest) {
+			largest = std::stoll(size);
+			dramBandwidth = std::stod(best);
+		}
+	}
+	if (largest > 0 && largest < FALLBACK_DRAM_SIZE)
+		std::cout << "Warning: the largest working set in " << fileName <<
+			" is small, the DRAM roof may be a cache one" << std::endl;
+	return largest > 0;
+}
+
+
+// roofline [memory_benchmark_bandwidth.csv]
+int main(int argc, char** argv) {
+
+	const std::string bandwidthFile = argc > 1 ? argv[1] : DEFAULT_BANDWIDTH_FILE;
+
+	const double peakFloat = measurePeakFlops<float>();
+	const double peakDouble = measurePeakFlops<double>();
+
+	double cacheBandwidth, dramBandwidth;
+	if (readBandwidth(bandwidthFile, cacheBandwidth, dramBandwidth)) {
+		std::cout << "Bandwidth is taken from " << bandwidthFile << std::endl;
+	}
+	else {
+		std::cout << "No " << bandwidthFile << ", measuring the triad" << std::endl;
+		cacheBandwidth = measureTriadBandwidth(FALLBACK_CACHE_SIZE);
+		dramBandwidth = measureTriadBandwidth(FALLBACK_DRAM_SIZE);
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Peak is " << peakFloat << " GFLOP/s (float), " << peakDouble << " GFLOP/s (double), one core" << std::endl;
+	std::cout << "Bandwidth is " << cacheBandwidth << " GB/s (L1), " << dramBandwidth << " GB/s (DRAM)" << std::endl;
+	std::cout << "Ridge point is " << peakFloat / dramBandwidth << " FLOP/byte (float), " <<
+		peakDouble / dramBandwidth << " FLOP/byte (double) for DRAM" << std::endl;
+	std::cout << std::endl;
+
+	std::ofstream csv(std::string(argv[0]) + "_roofline.csv");
+	csv << "kernel,precision,bytes_per_element,flops_per_element,flops_per_byte,peak_gflops," <<
+		"l1_gbps,dram_gbps,roof_l1_gflops,roof_dram_gflops,bound" << std::endl;
+
+	std::cout << std::setw(14) << "Kernel" << std::setw(8) << "Type" << std::setw(8) << "Bytes" <<
+		std::setw(8) << "FLOPs" << std::setw(11) << "FLOP/byte" << std::setw(10) << "Roof L1" <<
+		std::setw(11) << "Roof DRAM" << std::setw(10) << "Bound" << std::endl;
+	for (const RooflineKernel& kernel : ROOFLINE_KERNELS) {
+		const double peak = kernel.isDouble ? peakDouble : peakFloat;
+		const double intensity = kernel.flops / kernel.bytes;
+		const double roofCache = std::min(peak, intensity * cacheBandwidth);
+		const double roofDram = std::min(peak, intensity * dramBandwidth);
+		const std::string bound = roofDram < peak ? "memory" : "compute";
+
+		std::cout << std::setw(14) << kernel.name << std::setw(8) << (kernel.isDouble ? "double" : "float") <<
+			std::setw(8) << kernel.bytes << std::setw(8) << kernel.flops << std::setw(11) << intensity <<
+			std::setw(10) << roofCache << std::setw(11) << roofDram << std::setw(10) << bound << std::endl;
+		csv << kernel.name << "," << (kernel.isDouble ? "double" : "float") << "," << kernel.bytes << "," <<
+			kernel.flops << "," << intensity << "," << peak << "," << cacheBandwidth << "," << dramBandwidth << "," <<
+			roofCache << "," << roofDram << "," << bound << std::endl;
+	}
+	std::cout << "(GFLOP/s a kernel cannot exceed with its data in L1 or in DRAM)" << std::endl;
+
+	return 0;
+}
@@ -4,19 +4,39 @@ set list_number_run=0 1 2 3 4
 
 set program_list_compile_simple=gamma_rgb_v8_zmm_novec gamma_rgb_v0_base_novec gamma_rgb_v1_ivdep integral_v0_novec reduction_v0_novec
 set program_list_compile_vec=gamma_rgb_v2_xHost gamma_rgb_v3_unroll gamma_rgb_v4_mem_access gamma_rgb_v5_type gamma_rgb_v6_mem_align gamma_rgba_v0_novec
-set program_list_compile_zmm=gamma_rgb_v7_zmm gamma_rgba_v1_vec integral_v1_try_vec integral_v2_pragma_simd reduction_v1_vec
-set program_list=%program_list_compile_simple% %program_list_compile_vec% %program_list_compile_zmm%
+set program_list_compile_zmm=gamma_rgb_v7_zmm gamma_rgba_v1_vec integral_v1_try_vec integral_v2_pragma_simd reduction_v1_vec integral_v3_sqsum integral_v4_streaming reduction_v2_multiacc reduction_v3_uint8
+set program_list_compile_omp=integral_v5_fused_norm integral_v6_update blur_v0_integral reduction_v4_deterministic reduction_v5_profile histogram_v0_privatized levels_v0_lut tiles_v0_scheduler reduction_v6_batch
+set program_list=%program_list_compile_simple% %program_list_compile_vec% %program_list_compile_zmm% %program_list_compile_omp%
+rem run once, in this order: roofline reads the bandwidth table of memory_benchmark
+set program_list_once=memory_benchmark roofline
+
+set flags_simple=/debug /O2 /Qopt-report=5
+set flags_vec=%flags_simple% /QxHost
+set flags_zmm=%flags_vec% /Qopt-zmm-usage=high
+set flags_omp=%flags_zmm% /Qopenmp
+
+rem the build description stored with the results, see result_store.h
+set git_hash=unknown
+for /f %%H in ('git describe --always --dirty') do set git_hash=%%H
+set build_id=unknown
+for /f %%T in ('powershell -NoProfile -Command "Get-Date -Format yyyyMMddTHHmmss"') do set build_id=%%T
+set defines=/DBENCH_GIT_HASH=\"%git_hash%\" /DBENCH_BUILD_ID=\"%build_id%\"
 
 
 (for %%P in (%program_list_compile_simple%) do (
-	icl /debug /O2 /Qopt-report=5 -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
+	icl %flags_simple% %defines% "/DBENCH_FLAGS=\"%flags_simple%\"" -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
 ))
 (for %%P in (%program_list_compile_vec%) do (
-    icl /debug /O2 /Qopt-report=5 /QxHost -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
+    icl %flags_vec% %defines% "/DBENCH_FLAGS=\"%flags_vec%\"" -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
 ))
 (for %%P in (%program_list_compile_zmm%) do (
-	icl /debug /O2 /Qopt-report=5 /QxHost /Qopt-zmm-usage=high -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
+	icl %flags_zmm% %defines% "/DBENCH_FLAGS=\"%flags_zmm%\"" -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
+))
+(for %%P in (%program_list_compile_omp%) do (
+	icl %flags_omp% %defines% "/DBENCH_FLAGS=\"%flags_omp%\"" -I%%P\bmp_reader.h %%P\%%P.cpp -o %%P\%%P
 ))
+icl %flags_omp% %defines% "/DBENCH_FLAGS=\"%flags_omp%\"" memory_benchmark\memory_benchmark.cpp -o memory_benchmark\memory_benchmark
+icl %flags_zmm% %defines% "/DBENCH_FLAGS=\"%flags_zmm%\"" roofline\roofline.cpp -o roofline\roofline
 
 
 (for %%P in (%program_list%) do (
@@ -25,3 +45,11 @@ set program_list=%program_list_compile_simple% %program_list_compile_vec% %progr
         %%P\%%P
     ))
 ))
+(for %%P in (%program_list_once%) do (
+	echo %%P
+	%%P\%%P
+))
+
+rem slowdowns against the previous build in results.jsonl
+icl /O2 compare_results\compare_results.cpp -o compare_results\compare_results
+compare_results\compare_results results.jsonl
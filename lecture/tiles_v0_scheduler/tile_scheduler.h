@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <omp.h>
+
+
+struct Tile {
+	int row, col;  // position in the tile grid
+	int y, x;  // top-left pixel
+	int height, width;  // smaller than the nominal size at the bottom and right edges
+};
+
+
+// Splits a height x width image into a grid of tileHeight x tileWidth tiles
+// (row-major numbering) and runs kernels over them in parallel.
+class TileScheduler {
+
+	int height, width;
+	int tileHeight, tileWidth;
+	int nRows, nCols;
+
+public:
+
+	TileScheduler(int height, int width, int tileHeight, int tileWidth) :
+		height(height), width(width), tileHeight(tileHeight), tileWidth(tileWidth),
+		nRows((height + tileHeight - 1) / tileHeight), nCols((width + tileWidth - 1) / tileWidth) {}
+
+	int getRows() const { return nRows; }
+	int getCols() const { return nCols; }
+	int getTileCount() const { return nRows * nCols; }
+
+	Tile getTile(int row, int col) const {
+		Tile tile;
+		tile.row = row;
+		tile.col = col;
+		tile.y = row * tileHeight;
+		tile.x = col * tileWidth;
+		tile.height = std::min(tileHeight, height - tile.y);
+		tile.width = std::min(tileWidth, width - tile.x);
+		return tile;
+	}
+
+	Tile getTile(int index) const { return getTile(index / nCols, index % nCols); }
+
+	// func(const Tile&) is called once per tile, tiles are independent
+	template <class Func>
+	void forEach(Func func) const {
+		const int nTiles = getTileCount();
+		#pragma omp parallel for schedule(dynamic)
+		for (int t = 0; t < nTiles; t++)
+			func(getTile(t));
+	}
+
+};
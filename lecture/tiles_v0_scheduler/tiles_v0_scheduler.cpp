@@ -0,0 +1,219 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <omp.h>
+#include <algorithm>
+
+#include "bmp_reader.h"
+#include "../result_store.h"
+#include "tile_scheduler.h"
+#include "../trace.h"
+
+
+using IntensityType = float;
+using SumType = double;
+const IntensityType MIN_INTENSITY = 0, MAX_INTENSITY = 255;
+const int N_CHANNELS = 3;  // RGB
+const float GAMMA = 0.45f;
+const float FACTOR = std::pow(MAX_INTENSITY, 1.0f - GAMMA);
+const int TILE_SIZE = 64;
+
+float correctPixelIntensity(float x)
+{
+	float res = FACTOR * std::pow(x, GAMMA);
+	if (res < MIN_INTENSITY) res = MIN_INTENSITY;
+	if (res > MAX_INTENSITY) res = MAX_INTENSITY;
+	return res;
+}
+
+
+// grid[(row * nCols + col) * N_CHANNELS + k] is the mean of channel k over the tile
+__declspec(noinline) void tiledAverage(int height, int width, const TileScheduler& tiles,
+	const IntensityType* pixels, IntensityType* grid)
+{
+	TRACE_SCOPE("tiledAverage");
+	tiles.forEach([&](const Tile& tile) {
+		TRACE_SCOPE("average tile");
+		float sumR = 0.0f, sumG = 0.0f, sumB = 0.0f;
+		for (int i = tile.y; i < tile.y + tile.height; i++) {
+			const IntensityType* row = pixels + (i * width + tile.x) * N_CHANNELS;
+			#pragma omp simd reduction(+ : sumR, sumG, sumB)
+			for (int j = 0; j < tile.width; j++) {
+				sumR += row[N_CHANNELS * j];
+				sumG += row[N_CHANNELS * j + 1];
+				sumB += row[N_CHANNELS * j + 2];
+			}
+		}
+		IntensityType* mean = grid + (tile.row * tiles.getCols() + tile.col) * N_CHANNELS;
+		mean[0] = sumR / (tile.height * tile.width);
+		mean[1] = sumG / (tile.height * tile.width);
+		mean[2] = sumB / (tile.height * tile.width);
+	});
+}
+
+__declspec(noinline) void tiledNonlinearCorrection(int height, int width, const TileScheduler& tiles,
+	const IntensityType* pixels, IntensityType* result)
+{
+	TRACE_SCOPE("tiledNonlinearCorrection");
+	tiles.forEach([&](const Tile& tile) {
+		TRACE_SCOPE("gamma tile");
+		for (int i = tile.y; i < tile.y + tile.height; i++) {
+			const int offset = (i * width + tile.x) * N_CHANNELS;
+			#pragma ivdep
+			for (int e = 0; e < tile.width * N_CHANNELS; e++)
+				result[offset + e] = correctPixelIntensity(pixels[offset + e]);
+		}
+	});
+}
+
+// Summed-area table over tiles: (1) row prefix sums inside each tile, (2) carries
+// between tile columns, (3) carries added and column prefix sums inside each tile,
+// (4) carries between tile rows, (5) those carries added. Steps 1, 3 and 5 run
+// over the tiles in parallel, 2 and 4 only touch the tile borders.
+__declspec(noinline) void tiledIntegral(int height, int width, const TileScheduler& tiles,
+	const IntensityType* pixels, SumType* sum)
+{
+	TRACE_SCOPE("tiledIntegral");
+	const int nRows = tiles.getRows(), nCols = tiles.getCols();
+	std::vector<SumType> rowCarry(nCols * height * N_CHANNELS);  // sum of the row left of the tile
+	std::vector<SumType> colCarry(nRows * width * N_CHANNELS);  // sum of the column above the tile
+
+	tiles.forEach([&](const Tile& tile) {
+		TRACE_SCOPE("integral step 1 tile");
+		for (int i = tile.y; i < tile.y + tile.height; i++) {
+			const IntensityType* src = pixels + (i * width + tile.x) * N_CHANNELS;
+			SumType* dst = sum + (i * width + tile.x) * N_CHANNELS;
+			SumType rowSum[N_CHANNELS] = {};
+			for (int j = 0; j < tile.width; j++)
+				#pragma unroll
+				for (int k = 0; k < N_CHANNELS; k++) {
+					rowSum[k] += src[j * N_CHANNELS + k];
+					dst[j * N_CHANNELS + k] = rowSum[k];
+				}
+		}
+	});
+
+	#pragma omp parallel for
+	for (int i = 0; i < height; i++) {
+		SumType carry[N_CHANNELS] = {};
+		for (int c = 0; c < nCols; c++) {
+			const Tile tile = tiles.getTile(0, c);
+			for (int k = 0; k < N_CHANNELS; k++) {
+				rowCarry[(c * height + i) * N_CHANNELS + k] = carry[k];
+				carry[k] += sum[(i * width + tile.x + tile.width - 1) * N_CHANNELS + k];
+			}
+		}
+	}
+
+	tiles.forEach([&](const Tile& tile) {
+		TRACE_SCOPE("integral step 3 tile");
+		const int rowSize = tile.width * N_CHANNELS;
+		for (int i = tile.y; i < tile.y + tile.height; i++) {
+			const SumType* carry = rowCarry.data() + (tile.col * height + i) * N_CHANNELS;
+			SumType* row = sum + (i * width + tile.x) * N_CHANNELS;
+			const SumType* prev = row - width * N_CHANNELS;
+			const bool first = i == tile.y;
+			#pragma omp simd
+			for (int e = 0; e < rowSize; e++)
+				row[e] += carry[e % N_CHANNELS] + (first ? 0 : prev[e]);
+		}
+	});
+
+	#pragma omp parallel for
+	for (int e = 0; e < width * N_CHANNELS; e++) {
+		SumType carry = 0;
+		for (int r = 0; r < nRows; r++) {
+			const Tile tile = tiles.getTile(r, 0);
+			colCarry[r * width * N_CHANNELS + e] = carry;
+			carry += sum[(tile.y + tile.height - 1) * width * N_CHANNELS + e];
+		}
+	}
+
+	tiles.forEach([&](const Tile& tile) {
+		TRACE_SCOPE("integral step 5 tile");
+		const SumType* carry = colCarry.data() + (tile.row * width + tile.x) * N_CHANNELS;
+		for (int i = tile.y; i < tile.y + tile.height; i++) {
+			SumType* row = sum + (i * width + tile.x) * N_CHANNELS;
+			#pragma omp simd
+			for (int e = 0; e < tile.width * N_CHANNELS; e++)
+				row[e] += carry[e];
+		}
+	});
+}
+
+// reference for the check
+void integral(int height, int width, const IntensityType* pixels, SumType* sum)
+{
+	for (int i = 0; i < height; i++)
+		for (int j = 0; j < width; j++)
+			for (int k = 0; k < N_CHANNELS; k++) {
+				const int index = (i * width + j) * N_CHANNELS + k;
+				sum[index] = pixels[index] +
+					(i > 0 ? sum[index - width * N_CHANNELS] : 0) +
+					(j > 0 ? sum[index - N_CHANNELS] : 0) -
+					(i > 0 && j > 0 ? sum[index - (width + 1) * N_CHANNELS] : 0);
+			}
+}
+
+
+int main(int argc, char** argv) {
+
+	BMPReader reader;
+	std::vector<IntensityType> pixels;
+	{
+		TRACE_SCOPE("load");
+		if (!reader.open("photo.bmp")) {
+			std::cout << "Error when reading" << std::endl;
+			return 0;
+		}
+		pixels = reader.getRGBPixels<IntensityType>();
+	}
+	const int height = reader.getHeight(), width = reader.getWidth();
+
+	TileScheduler tiles(height, width, TILE_SIZE, TILE_SIZE);
+	std::vector<IntensityType> grid(tiles.getTileCount() * N_CHANNELS);
+	std::vector<IntensityType> gammaPixels(pixels.size());
+	std::vector<SumType> sum(pixels.size()), reference(pixels.size());
+
+	auto t0 = std::chrono::steady_clock::now();
+	tiledAverage(height, width, tiles, pixels.data(), grid.data());
+	auto t1 = std::chrono::steady_clock::now();
+	tiledNonlinearCorrection(height, width, tiles, pixels.data(), gammaPixels.data());
+	auto t2 = std::chrono::steady_clock::now();
+	tiledIntegral(height, width, tiles, pixels.data(), sum.data());
+	auto t3 = std::chrono::steady_clock::now();
+
+	std::cout << "Grid is " << tiles.getCols() << "x" << tiles.getRows() << " tiles" << std::endl;
+	std::cout << "Tiled average time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()/1e6 << " sec" << std::endl;
+	std::cout << "Tiled gamma time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()/1e6 << " sec" << std::endl;
+	std::cout << "Tiled integral time is " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()/1e6 << " sec" << std::endl;
+	saveResult(argv[0], "tiledAverage", { std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1e6 });
+	saveResult(argv[0], "tiledNonlinearCorrection", { std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1e6 });
+	saveResult(argv[0], "tiledIntegral", { std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1e6 });
+
+	integral(height, width, pixels.data(), reference.data());
+	if (sum != reference)
+		std::cout << "ERROR: WRONG INTEGRAL!!!" << std::endl;
+
+	// exposure map: every tile filled with its mean
+	std::vector<IntensityType> means(pixels.size());
+	for (int i = 0; i < height; i++)
+		for (int j = 0; j < width; j++)
+			for (int k = 0; k < N_CHANNELS; k++)
+				means[(i * width + j) * N_CHANNELS + k] =
+					grid[((i / TILE_SIZE) * tiles.getCols() + j / TILE_SIZE) * N_CHANNELS + k];
+
+	{
+		TRACE_SCOPE("save");
+		reader.saveRGB(std::string(argv[0]) + "_means.bmp", means);
+		reader.saveRGB(std::string(argv[0]) + "_gamma.bmp", gammaPixels);
+	}
+	TRACE_SAVE(std::string(argv[0]) + "_trace.json");
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+// Timeline of named scopes in the Chrome trace format (open the file in
+// https://ui.perfetto.dev or chrome://tracing). Compiled in only with WITH_TRACE:
+//
+//	void kernel() {
+//		TRACE_SCOPE("kernel");
+//		...
+//	}
+//	...
+//	TRACE_SAVE(std::string(argv[0]) + "_trace.json");
+//
+// Each thread writes its events into its own ring buffer without locks, only
+// the first event of a thread takes a mutex to register the buffer. When a
+// buffer is full the oldest events are overwritten.
+
+#ifdef WITH_TRACE
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SAVE(fileName) Tracer::save(fileName)
+
+
+const int TRACE_BUFFER_SIZE = 1 << 16;  // events per thread
+
+
+struct TraceEvent {
+	const char* name;  // a string literal, only the pointer is stored
+	int64_t begin, end;  // ns since the start of the program
+};
+
+struct TraceBuffer {
+	int thread;
+	std::vector<TraceEvent> events;
+	int64_t count = 0;  // all events ever written, the buffer keeps the last TRACE_BUFFER_SIZE
+
+	TraceBuffer(int thread) : thread(thread), events(TRACE_BUFFER_SIZE) {}
+};
+
+
+class Tracer {
+
+	static std::mutex& getMutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	// the buffers outlive their threads, so save() sees the events of finished ones
+	static std::vector<std::unique_ptr<TraceBuffer>>& getBuffers() {
+		static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+		return buffers;
+	}
+
+	static TraceBuffer* registerThread() {
+		std::lock_guard<std::mutex> lock(getMutex());
+		std::vector<std::unique_ptr<TraceBuffer>>& buffers = getBuffers();
+		buffers.emplace_back(new TraceBuffer(buffers.size()));
+		return buffers.back().get();
+	}
+
+public:
+
+	static int64_t now() {
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	static void record(const char* name, int64_t begin, int64_t end) {
+		thread_local TraceBuffer* buffer = registerThread();
+		buffer->events[buffer->count % TRACE_BUFFER_SIZE] = { name, begin, end };
+		buffer->count++;
+	}
+
+	// call it when no other thread is tracing
+	static void save(const std::string& fileName) {
+		std::lock_guard<std::mutex> lock(getMutex());
+		std::ofstream file(fileName);
+		file << std::fixed << std::setprecision(3);  // us with ns resolution
+		file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+		bool first = true;
+		for (const std::unique_ptr<TraceBuffer>& buffer : getBuffers()) {
+			file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " <<
+				buffer->thread << ", \"args\": {\"name\": \"thread " << buffer->thread << "\"}}";
+			first = false;
+			const int64_t oldest = buffer->count > TRACE_BUFFER_SIZE ? buffer->count - TRACE_BUFFER_SIZE : 0;
+			for (int64_t e = oldest; e < buffer->count; e++) {
+				const TraceEvent& event = buffer->events[e % TRACE_BUFFER_SIZE];
+				file << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " <<
+					buffer->thread << ", \"ts\": " << event.begin / 1000.0 << ", \"dur\": " <<
+					(event.end - event.begin) / 1000.0 << "}";
+			}
+		}
+		file << std::endl << "]}" << std::endl;
+	}
+
+};
+
+
+// one complete event from the constructor to the destructor
+class TraceScope {
+
+	const char* name;
+	int64_t begin;
+
+public:
+
+	TraceScope(const char* name) : name(name), begin(Tracer::now()) {}
+	~TraceScope() { Tracer::record(name, begin, Tracer::now()); }
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+};
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_SAVE(fileName)
+
+#endif
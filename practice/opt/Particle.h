@@ -0,0 +1,223 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "Vector3.h"
+
+
+struct Particle {
+
+	Vector3 r, v;  // position and velocity
+
+	Particle() {}
+	Particle(Vector3 r, Vector3 v) :r(r), v(v) {}
+
+};
+
+
+// Layouts of the particles in memory. Every layout gives the same read-write
+// access to the components of a particle: Rx(index), ..., Vz(index).
+// For vector loops a layout also splits the particles into blocks of pointers,
+// getBlock(0), ..., getBlock(getBlockCount() - 1). The component of particle i
+// of a block is at the pointer + i * STRIDE, STRIDE is a constant of the layout.
+
+struct ParticleBlock {
+
+	FP* rx, * ry, * rz;
+	FP* vx, * vy, * vz;
+	int size;  // number of particles
+
+};
+
+struct AoS {  // Array of Structures
+
+	std::vector<Particle> ensemble;
+
+	AoS(const std::vector<Particle>& particles) :
+		ensemble(particles) {}
+
+	static std::string getName() { return "AoS"; }
+
+	static const int STRIDE = sizeof(Particle) / sizeof(FP);  // r and v of the next particle
+	static_assert(sizeof(Particle) == 6 * sizeof(FP), "Particle is r and v without padding");
+
+	// one block of all particles, the loads are strided
+	int getBlockCount() const { return ensemble.empty() ? 0 : 1; }
+	ParticleBlock getBlock(int) {
+		Particle* p = ensemble.data();
+		return { &p->r.x, &p->r.y, &p->r.z, &p->v.x, &p->v.y, &p->v.z, (int)ensemble.size() };
+	}
+
+	// hint: use only for AoS data stucture
+	Particle& operator[] (int index) { return ensemble[index]; }
+
+	FP& Rx(int index) { return ensemble[index].r.x; }
+	FP& Ry(int index) { return ensemble[index].r.y; }
+	FP& Rz(int index) { return ensemble[index].r.z; }
+
+	FP& Vx(int index) { return ensemble[index].v.x; }
+	FP& Vy(int index) { return ensemble[index].v.y; }
+	FP& Vz(int index) { return ensemble[index].v.z; }
+
+	const FP& Rx(int index) const { return ensemble[index].r.x; }
+	const FP& Ry(int index) const { return ensemble[index].r.y; }
+	const FP& Rz(int index) const { return ensemble[index].r.z; }
+
+	const FP& Vx(int index) const { return ensemble[index].v.x; }
+	const FP& Vy(int index) const { return ensemble[index].v.y; }
+	const FP& Vz(int index) const { return ensemble[index].v.z; }
+
+	int getSize() const { return ensemble.size(); }
+
+};
+
+
+struct SoA {  // Structure of Arrays
+
+	std::vector<FP> rx, ry, rz;
+	std::vector<FP> vx, vy, vz;
+
+	SoA(const std::vector<Particle>& particles) :
+		rx(particles.size()), ry(particles.size()), rz(particles.size()),
+		vx(particles.size()), vy(particles.size()), vz(particles.size())
+	{
+		for (int i = 0; i < (int)particles.size(); i++) {
+			Rx(i) = particles[i].r.x;
+			Ry(i) = particles[i].r.y;
+			Rz(i) = particles[i].r.z;
+
+			Vx(i) = particles[i].v.x;
+			Vy(i) = particles[i].v.y;
+			Vz(i) = particles[i].v.z;
+		}
+	}
+
+	static std::string getName() { return "SoA"; }
+
+	static const int STRIDE = 1;
+
+	// one block of all particles, every component is contiguous
+	int getBlockCount() const { return rx.empty() ? 0 : 1; }
+	ParticleBlock getBlock(int) {
+		return { rx.data(), ry.data(), rz.data(), vx.data(), vy.data(), vz.data(), (int)rx.size() };
+	}
+
+	FP* getRxPtr() { return rx.data(); }
+	FP* getRyPtr() { return ry.data(); }
+	FP* getRzPtr() { return rz.data(); }
+
+	FP* getVxPtr() { return vx.data(); }
+	FP* getVyPtr() { return vy.data(); }
+	FP* getVzPtr() { return vz.data(); }
+
+	FP& Rx(int index) { return rx[index]; }
+	FP& Ry(int index) { return ry[index]; }
+	FP& Rz(int index) { return rz[index]; }
+
+	FP& Vx(int index) { return vx[index]; }
+	FP& Vy(int index) { return vy[index]; }
+	FP& Vz(int index) { return vz[index]; }
+
+	const FP& Rx(int index) const { return rx[index]; }
+	const FP& Ry(int index) const { return ry[index]; }
+	const FP& Rz(int index) const { return rz[index]; }
+
+	const FP& Vx(int index) const { return vx[index]; }
+	const FP& Vy(int index) const { return vy[index]; }
+	const FP& Vz(int index) const { return vz[index]; }
+
+	int getSize() const { return rx.size(); }
+
+};
+
+
+// Array of Structures of Arrays: blocks of W particles stored as SoA, so a block
+// is W-wide vectors and the blocks go one after another in memory as in AoS.
+// W is best a power of 2 equal to the vector width (8 doubles for zmm).
+template <int W>
+struct AoSoA {
+
+	struct Block {
+		FP rx[W], ry[W], rz[W];
+		FP vx[W], vy[W], vz[W];
+	};
+
+	std::vector<Block> blocks;
+	int size;
+
+	AoSoA(const std::vector<Particle>& particles) :
+		blocks((particles.size() + W - 1) / W), size(particles.size())
+	{
+		for (int i = 0; i < size; i++) {
+			Rx(i) = particles[i].r.x;
+			Ry(i) = particles[i].r.y;
+			Rz(i) = particles[i].r.z;
+
+			Vx(i) = particles[i].v.x;
+			Vy(i) = particles[i].v.y;
+			Vz(i) = particles[i].v.z;
+		}
+	}
+
+	static std::string getName() { return "AoSoA<" + std::to_string(W) + ">"; }
+
+	static const int STRIDE = 1;
+
+	// the blocks of W particles, the last one may be incomplete
+	int getBlockCount() const { return blocks.size(); }
+	ParticleBlock getBlock(int index) {
+		Block& block = blocks[index];
+		return { block.rx, block.ry, block.rz, block.vx, block.vy, block.vz, std::min(W, size - index * W) };
+	}
+
+	FP& Rx(int index) { return blocks[index / W].rx[index % W]; }
+	FP& Ry(int index) { return blocks[index / W].ry[index % W]; }
+	FP& Rz(int index) { return blocks[index / W].rz[index % W]; }
+
+	FP& Vx(int index) { return blocks[index / W].vx[index % W]; }
+	FP& Vy(int index) { return blocks[index / W].vy[index % W]; }
+	FP& Vz(int index) { return blocks[index / W].vz[index % W]; }
+
+	const FP& Rx(int index) const { return blocks[index / W].rx[index % W]; }
+	const FP& Ry(int index) const { return blocks[index / W].ry[index % W]; }
+	const FP& Rz(int index) const { return blocks[index / W].rz[index % W]; }
+
+	const FP& Vx(int index) const { return blocks[index / W].vx[index % W]; }
+	const FP& Vy(int index) const { return blocks[index / W].vy[index % W]; }
+	const FP& Vz(int index) const { return blocks[index / W].vz[index % W]; }
+
+	int getSize() const { return size; }
+
+};
+
+
+// Layout is AoS, SoA or AoSoA<W>, the code that uses the ensemble does not depend on it
+template <class Layout = AoS>
+class ParticleEnsemble : public Layout {
+
+public:
+
+	ParticleEnsemble(const std::vector<Particle>& particles) :
+		Layout(particles) {}
+
+	// read access
+	Vector3 getR(int index) const { return Vector3(this->Rx(index), this->Ry(index), this->Rz(index)); }
+	Vector3 getV(int index) const { return Vector3(this->Vx(index), this->Vy(index), this->Vz(index)); }
+
+	// write access
+	void setR(int index, const Vector3& r) {
+		this->Rx(index) = r.x;
+		this->Ry(index) = r.y;
+		this->Rz(index) = r.z;
+	}
+	void setV(int index, const Vector3& v) {
+		this->Vx(index) = v.x;
+		this->Vy(index) = v.y;
+		this->Vz(index) = v.z;
+	}
+
+	Particle getParticle(int index) const {
+		return Particle(getR(index), getV(index));
+	}
+
+};
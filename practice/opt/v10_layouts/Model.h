@@ -0,0 +1,83 @@
+#pragma once
+#include "../Particle.h"
+
+
+// some physical constants
+const FP ELECTRON_MASS = 9.10938215e-28;
+const FP ELECTRON_CHARGE = -4.80320427e-10;
+const FP LIGHT_VELOCITY = 29979245800.0;  // CGS
+
+
+// Ensemble is ParticleEnsemble<Layout> with any of the layouts of ../Particle.h
+template <class Ensemble = ParticleEnsemble<>>
+class Model {
+
+	const Vector3 E, B;  // constant electromagnetic field
+	Ensemble particles;
+
+public:
+
+	Model(const Vector3& E, const Vector3& B,
+		const std::vector<Particle>& particles) :
+		E(E), B(B), particles(particles) {}
+
+	const Ensemble& getParticles() { return particles; }
+
+	// The loops go over the blocks of the layout, so the inner loops are vector
+	// loops over unit-stride (SoA, AoSoA) or strided (AoS) components.
+__declspec(noinline) void update(const FP& dt) {  // dt is the time step
+		const FP coeffR = dt / (FP)6;
+		const FP coeffV = coeffR / ELECTRON_MASS;
+		const FP invLightVelocity = (FP)1.0 / LIGHT_VELOCITY;
+		const int stride = Ensemble::STRIDE;
+		const Vector3 E = this->E, B = this->B;
+
+		for (int b = 0; b < particles.getBlockCount(); b++) {
+			const ParticleBlock block = particles.getBlock(b);
+#ifdef __NOVECTOR__
+#pragma novector
+#else
+#pragma omp simd
+#endif
+			for (int i = 0; i < block.size; i++) {
+				const int j = i * stride;
+				FP vx = block.vx[j], vy = block.vy[j], vz = block.vz[j];
+
+				// compute the new particle position (RK4)
+				FP k1x = vx, k1y = vy, k1z = vz;
+				FP k2x = vx + (FP)0.5 * dt * k1x, k2y = vy + (FP)0.5 * dt * k1y, k2z = vz + (FP)0.5 * dt * k1z;
+				FP k3x = vx + (FP)0.5 * dt * k2x, k3y = vy + (FP)0.5 * dt * k2y, k3z = vz + (FP)0.5 * dt * k2z;
+				FP k4x = vx + dt * k3x, k4y = vy + dt * k3y, k4z = vz + dt * k3z;
+
+				block.rx[j] += coeffR * (k1x + (FP)2 * k2x + (FP)2 * k3x + k4x);
+				block.ry[j] += coeffR * (k1y + (FP)2 * k2y + (FP)2 * k3y + k4y);
+				block.rz[j] += coeffR * (k1z + (FP)2 * k2z + (FP)2 * k3z + k4z);
+
+				// compute the new particle velocity (RK4), the Lorentz force of v, v + dt/2 k1, ...
+				k1x = ELECTRON_CHARGE * (E.x + (vy * B.z - vz * B.y) * invLightVelocity);
+				k1y = ELECTRON_CHARGE * (E.y + (vz * B.x - vx * B.z) * invLightVelocity);
+				k1z = ELECTRON_CHARGE * (E.z + (vx * B.y - vy * B.x) * invLightVelocity);
+
+				FP tmpx = vx + (FP)0.5 * dt * k1x, tmpy = vy + (FP)0.5 * dt * k1y, tmpz = vz + (FP)0.5 * dt * k1z;
+				k2x = ELECTRON_CHARGE * (E.x + (tmpy * B.z - tmpz * B.y) * invLightVelocity);
+				k2y = ELECTRON_CHARGE * (E.y + (tmpz * B.x - tmpx * B.z) * invLightVelocity);
+				k2z = ELECTRON_CHARGE * (E.z + (tmpx * B.y - tmpy * B.x) * invLightVelocity);
+
+				tmpx = vx + (FP)0.5 * dt * k2x; tmpy = vy + (FP)0.5 * dt * k2y; tmpz = vz + (FP)0.5 * dt * k2z;
+				k3x = ELECTRON_CHARGE * (E.x + (tmpy * B.z - tmpz * B.y) * invLightVelocity);
+				k3y = ELECTRON_CHARGE * (E.y + (tmpz * B.x - tmpx * B.z) * invLightVelocity);
+				k3z = ELECTRON_CHARGE * (E.z + (tmpx * B.y - tmpy * B.x) * invLightVelocity);
+
+				tmpx = vx + dt * k3x; tmpy = vy + dt * k3y; tmpz = vz + dt * k3z;
+				k4x = ELECTRON_CHARGE * (E.x + (tmpy * B.z - tmpz * B.y) * invLightVelocity);
+				k4y = ELECTRON_CHARGE * (E.y + (tmpz * B.x - tmpx * B.z) * invLightVelocity);
+				k4z = ELECTRON_CHARGE * (E.z + (tmpx * B.y - tmpy * B.x) * invLightVelocity);
+
+				block.vx[j] = vx + coeffV * (k1x + (FP)2 * k2x + (FP)2 * k3x + k4x);
+				block.vy[j] = vy + coeffV * (k1y + (FP)2 * k2y + (FP)2 * k3y + k4y);
+				block.vz[j] = vz + coeffV * (k1z + (FP)2 * k2z + (FP)2 * k3z + k4z);
+			}
+		}
+	}
+
+};
@@ -40,7 +40,7 @@ std::pair<Vector3, Vector3> getAnalyticalSolution(FP time) {
 }
 
 
-bool checkResult(const ParticleEnsemble& particles, FP time) {
+bool checkResult(const Ensemble& particles, FP time) {
     FP eps = 1e-4*LIGHT_VELOCITY;
     for (int i = 0; i < particles.getSize(); i++) {
         std::pair<Vector3, Vector3> analyticalSolution = getAnalyticalSolution(time);
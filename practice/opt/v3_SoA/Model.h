@@ -1,5 +1,9 @@
 #pragma once
-#include "Particle.h"
+#include "../Particle.h"
+
+
+// the ensemble of this version, layouts are in ../Particle.h
+using Ensemble = ParticleEnsemble<SoA>;
 
 
 const FP ELECTRON_MASS = 9.10938215e-28;
@@ -10,7 +14,7 @@ const FP LIGHT_VELOCITY = 29979245800.0;  // CGS
 class Model {
 
 	const Vector3 E, B;  // constant electromagnetic field
-	ParticleEnsemble particles;
+	Ensemble particles;
 
 public:
 
@@ -18,7 +22,7 @@ public:
 		const std::vector<Particle>& particles) :
 		E(E), B(B), particles(particles) {}
  
-	const ParticleEnsemble& getParticles() { return particles; }
+	const Ensemble& getParticles() { return particles; }
 
 __declspec(noinline) void update(const FP& dt) {
 		
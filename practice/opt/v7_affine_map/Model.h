@@ -0,0 +1,133 @@
+#pragma once
+#include "../Particle.h"
+
+
+// the ensemble of this version, layouts are in ../Particle.h
+using Ensemble = ParticleEnsemble<SoA>;
+
+
+const FP ELECTRON_MASS = 9.10938215e-28;
+const FP ELECTRON_CHARGE = -4.80320427e-10;
+const FP LIGHT_VELOCITY = 29979245800.0;  // CGS
+
+
+// With constant E and B the force is linear in v, so one RK4 step is an affine map:
+// v' = M * v + c, r' = r + P * v + d.
+// The map is built once per dt by applying the RK4 step to v = 0 and to the basis
+// vectors, then every particle needs two 3x3 mat-vecs instead of four forces.
+struct AffineMap {
+	FP m[3][3], c[3];  // v
+	FP p[3][3], d[3];  // r
+};
+
+
+class Model {
+
+	const Vector3 E, B;  // constant electromagnetic field
+	Ensemble particles;
+
+	AffineMap map;
+	FP mapDt = (FP)0.0;  // dt of the map, 0 if it is not built yet
+
+public:
+
+	Model(const Vector3& E, const Vector3& B,
+		const std::vector<Particle>& particles) :
+		E(E), B(B), particles(particles) {}
+
+	const Ensemble& getParticles() { return particles; }
+
+__declspec(noinline) void update(const FP& dt) {
+		if (dt != mapDt) {
+			buildMap(dt);
+			mapDt = dt;
+		}
+		const int nParticles = particles.getSize();
+
+		const FP m00 = map.m[0][0], m01 = map.m[0][1], m02 = map.m[0][2];
+		const FP m10 = map.m[1][0], m11 = map.m[1][1], m12 = map.m[1][2];
+		const FP m20 = map.m[2][0], m21 = map.m[2][1], m22 = map.m[2][2];
+		const FP p00 = map.p[0][0], p01 = map.p[0][1], p02 = map.p[0][2];
+		const FP p10 = map.p[1][0], p11 = map.p[1][1], p12 = map.p[1][2];
+		const FP p20 = map.p[2][0], p21 = map.p[2][1], p22 = map.p[2][2];
+		const FP cx = map.c[0], cy = map.c[1], cz = map.c[2];
+		const FP dx = map.d[0], dy = map.d[1], dz = map.d[2];
+
+		FP* rxPtr = particles.getRxPtr(), * ryPtr = particles.getRyPtr(), * rzPtr = particles.getRzPtr();
+		FP* vxPtr = particles.getVxPtr(), * vyPtr = particles.getVyPtr(), * vzPtr = particles.getVzPtr();
+
+#ifdef __NOVECTOR__
+#pragma novector
+#else
+#pragma omp simd
+#endif
+		for (int i = 0; i < nParticles; i++) {
+			FP vx = vxPtr[i], vy = vyPtr[i], vz = vzPtr[i];
+
+			rxPtr[i] += p00 * vx + p01 * vy + p02 * vz + dx;
+			ryPtr[i] += p10 * vx + p11 * vy + p12 * vz + dy;
+			rzPtr[i] += p20 * vx + p21 * vy + p22 * vz + dz;
+
+			vxPtr[i] = m00 * vx + m01 * vy + m02 * vz + cx;
+			vyPtr[i] = m10 * vx + m11 * vy + m12 * vz + cy;
+			vzPtr[i] = m20 * vx + m21 * vy + m22 * vz + cz;
+		}
+	}
+
+private:
+
+	Vector3 getLorentzForce(const Vector3& v) {
+		return ELECTRON_CHARGE * (E + cross(v, B) / LIGHT_VELOCITY);
+	}
+
+	// the RK4 step of the previous versions for one particle, returns dr and dv
+	void rk4Step(const Vector3& v, const FP& dt, Vector3& dr, Vector3& dv) {
+		const FP coeffR = dt / (FP)6;
+		const FP coeffV = coeffR / ELECTRON_MASS;
+
+		Vector3 k1 = v;
+		Vector3 k2 = v + (FP)0.5 * dt * k1;
+		Vector3 k3 = v + (FP)0.5 * dt * k2;
+		Vector3 k4 = v + dt * k3;
+		dr = coeffR * (k1 + (FP)2 * k2 + (FP)2 * k3 + k4);
+
+		k1 = getLorentzForce(v);
+		k2 = getLorentzForce(v + (FP)0.5 * dt * k1);
+		k3 = getLorentzForce(v + (FP)0.5 * dt * k2);
+		k4 = getLorentzForce(v + dt * k3);
+		dv = coeffV * (k1 + (FP)2 * k2 + (FP)2 * k3 + k4);
+	}
+
+	// Columns are the steps of the basis vectors minus the step of v = 0. A unit
+	// velocity would be lost against E in the force, so the basis is scaled to
+	// the speed of light.
+	void buildMap(const FP& dt) {
+		Vector3 dr0, dv0;
+		rk4Step(Vector3(), dt, dr0, dv0);
+
+		const FP scale = LIGHT_VELOCITY;
+		for (int j = 0; j < 3; j++) {
+			Vector3 basis;
+			(j == 0 ? basis.x : j == 1 ? basis.y : basis.z) = scale;
+			Vector3 dr, dv;
+			rk4Step(basis, dt, dr, dv);
+			dr -= dr0;
+			dv -= dv0;
+
+			map.p[0][j] = dr.x / scale;
+			map.p[1][j] = dr.y / scale;
+			map.p[2][j] = dr.z / scale;
+
+			map.m[0][j] = dv.x / scale;
+			map.m[1][j] = dv.y / scale;
+			map.m[2][j] = dv.z / scale;
+		}
+		map.m[0][0] += (FP)1;
+		map.m[1][1] += (FP)1;
+		map.m[2][2] += (FP)1;
+
+		map.c[0] = dv0.x; map.c[1] = dv0.y; map.c[2] = dv0.z;
+		map.d[0] = dr0.x; map.d[1] = dr0.y; map.d[2] = dr0.z;
+	}
+
+};
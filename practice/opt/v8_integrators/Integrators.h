@@ -0,0 +1,236 @@
+#pragma once
+#include <cmath>
+#include "../Vector3.h"
+
+
+const FP ELECTRON_MASS = 9.10938215e-28;
+const FP ELECTRON_CHARGE = -4.80320427e-10;
+const FP LIGHT_VELOCITY = 29979245800.0;  // CGS
+
+
+// Integrators are policies of Model: push() moves one particle by dt in the
+// constant field. They are inlined into the vectorized loops of Model, so
+// everything is on scalars.
+//
+// RK4 is the classic fourth order scheme for the pair (r, v): four force
+// evaluations per step, r and v at the same time. The scheme of the previous
+// versions moves r with the old velocity only and drops the mass in the
+// stages, so it is first order; it is not repeated here.
+//
+// Boris, Vay and Higuera-Cary use one field evaluation per step and are
+// leapfrog schemes: v is stored half a step behind r. After n steps from
+// v(-dt/2) r is r(n dt) and v is v((n - 1/2) dt), isStaggered() tells this to
+// the caller. Boris NR is the classic non-relativistic Boris scheme, which is
+// the model of RK4. The non-relativistic limit of all three is Boris NR, so
+// they are written in the relativistic form (u = gamma * v), where they
+// differ. The ensemble stores v, at V0 = 0.01c gamma - 1 is 5e-5, and the
+// orbit of a relativistic pusher is slower than the non-relativistic one by
+// this factor.
+
+
+struct Rk4 {
+
+	static const char* getName() { return "RK4"; }
+	static bool isStaggered() { return false; }
+
+	// acceleration q / m (E + v x B / c)
+	static void getAcceleration(FP vx, FP vy, FP vz, const Vector3& E, const Vector3& B,
+		FP& ax, FP& ay, FP& az) {
+		const FP coeff = ELECTRON_CHARGE / ELECTRON_MASS;
+		const FP invLightVelocity = (FP)1.0 / LIGHT_VELOCITY;
+		ax = coeff * (E.x + (vy * B.z - vz * B.y) * invLightVelocity);
+		ay = coeff * (E.y + (vz * B.x - vx * B.z) * invLightVelocity);
+		az = coeff * (E.z + (vx * B.y - vy * B.x) * invLightVelocity);
+	}
+
+	// dr/dt = v does not depend on r, so the stages of r are the stages of v
+	static void push(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		const Vector3& E, const Vector3& B, const FP dt) {
+		const FP coeff = dt / (FP)6;
+		const FP halfDt = (FP)0.5 * dt;
+
+		FP a1x, a1y, a1z;
+		getAcceleration(vx, vy, vz, E, B, a1x, a1y, a1z);
+
+		const FP v2x = vx + halfDt * a1x, v2y = vy + halfDt * a1y, v2z = vz + halfDt * a1z;
+		FP a2x, a2y, a2z;
+		getAcceleration(v2x, v2y, v2z, E, B, a2x, a2y, a2z);
+
+		const FP v3x = vx + halfDt * a2x, v3y = vy + halfDt * a2y, v3z = vz + halfDt * a2z;
+		FP a3x, a3y, a3z;
+		getAcceleration(v3x, v3y, v3z, E, B, a3x, a3y, a3z);
+
+		const FP v4x = vx + dt * a3x, v4y = vy + dt * a3y, v4z = vz + dt * a3z;
+		FP a4x, a4y, a4z;
+		getAcceleration(v4x, v4y, v4z, E, B, a4x, a4y, a4z);
+
+		rx += coeff * (vx + (FP)2 * v2x + (FP)2 * v3x + v4x);
+		ry += coeff * (vy + (FP)2 * v2y + (FP)2 * v3y + v4y);
+		rz += coeff * (vz + (FP)2 * v2z + (FP)2 * v3z + v4z);
+
+		vx += coeff * (a1x + (FP)2 * a2x + (FP)2 * a3x + a4x);
+		vy += coeff * (a1y + (FP)2 * a2y + (FP)2 * a3y + a4y);
+		vz += coeff * (a1z + (FP)2 * a2z + (FP)2 * a3z + a4z);
+	}
+
+};
+
+
+// J. P. Boris (1970), non-relativistic: half an electric kick, a rotation in B,
+// half an electric kick, then r with the new velocity
+struct BorisNonRelativistic {
+
+	static const char* getName() { return "Boris NR"; }
+	static bool isStaggered() { return true; }
+
+	static void push(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		const Vector3& E, const Vector3& B, const FP dt) {
+		const FP eps = ELECTRON_CHARGE * dt / ((FP)2 * ELECTRON_MASS);
+		FP ux = vx + eps * E.x, uy = vy + eps * E.y, uz = vz + eps * E.z;
+
+		// t = q B dt / (2 m c), the rotation u' = u- + u- x t, u+ = u- + u' x s
+		const FP coeffT = eps / LIGHT_VELOCITY;
+		const FP tx = coeffT * B.x, ty = coeffT * B.y, tz = coeffT * B.z;
+		const FP coeffS = (FP)2 / ((FP)1 + tx * tx + ty * ty + tz * tz);
+		const FP px = ux + (uy * tz - uz * ty), py = uy + (uz * tx - ux * tz), pz = uz + (ux * ty - uy * tx);
+		ux += coeffS * (py * tz - pz * ty);
+		uy += coeffS * (pz * tx - px * tz);
+		uz += coeffS * (px * ty - py * tx);
+
+		vx = ux + eps * E.x;
+		vy = uy + eps * E.y;
+		vz = uz + eps * E.z;
+		rx += vx * dt;
+		ry += vy * dt;
+		rz += vz * dt;
+	}
+
+};
+
+
+// common parts of the relativistic pushers
+struct RelativisticPusher {
+
+	static bool isStaggered() { return true; }
+
+	static FP getGamma(FP ux, FP uy, FP uz) {
+		const FP invC2 = (FP)1.0 / (LIGHT_VELOCITY * LIGHT_VELOCITY);
+		return std::sqrt((FP)1 + (ux * ux + uy * uy + uz * uz) * invC2);
+	}
+
+	// gamma at the end of the step from u without the magnetic part and
+	// tau = q B dt / (2 m c), Vay and Higuera-Cary solve the same equation
+	static FP getNewGamma(FP ux, FP uy, FP uz, FP tx, FP ty, FP tz) {
+		const FP gamma = getGamma(ux, uy, uz);
+		const FP tau2 = tx * tx + ty * ty + tz * tz;
+		const FP uStar = (ux * tx + uy * ty + uz * tz) / LIGHT_VELOCITY;
+		const FP sigma = gamma * gamma - tau2;
+		return std::sqrt((FP)0.5 * (sigma + std::sqrt(sigma * sigma + (FP)4 * (tau2 + uStar * uStar))));
+	}
+
+	// u' = s * (u + (u.t) t + u x t), s = 1 / (1 + t^2): u rotated by the angle of t
+	static void rotate(FP& ux, FP& uy, FP& uz, FP tx, FP ty, FP tz) {
+		const FP s = (FP)1 / ((FP)1 + tx * tx + ty * ty + tz * tz);
+		const FP ut = ux * tx + uy * ty + uz * tz;
+		const FP x = s * (ux + ut * tx + (uy * tz - uz * ty));
+		const FP y = s * (uy + ut * ty + (uz * tx - ux * tz));
+		const FP z = s * (uz + ut * tz + (ux * ty - uy * tx));
+		ux = x; uy = y; uz = z;
+	}
+
+	// r with the new velocity, back from u to v
+	static void move(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		FP ux, FP uy, FP uz, const FP dt) {
+		const FP invGamma = (FP)1 / getGamma(ux, uy, uz);
+		vx = ux * invGamma;
+		vy = uy * invGamma;
+		vz = uz * invGamma;
+		rx += vx * dt;
+		ry += vy * dt;
+		rz += vz * dt;
+	}
+
+};
+
+
+struct Boris : RelativisticPusher {
+
+	static const char* getName() { return "Boris"; }
+
+	static void push(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		const Vector3& E, const Vector3& B, const FP dt) {
+		const FP eps = ELECTRON_CHARGE * dt / ((FP)2 * ELECTRON_MASS);
+		const FP gamma = getGamma(vx, vy, vz);
+		FP ux = gamma * vx + eps * E.x, uy = gamma * vy + eps * E.y, uz = gamma * vz + eps * E.z;
+
+		// t = tau / gamma(u-), the rotation u' = u- + u- x t, u+ = u- + u' x s
+		const FP coeffT = eps / (LIGHT_VELOCITY * getGamma(ux, uy, uz));
+		const FP tx = coeffT * B.x, ty = coeffT * B.y, tz = coeffT * B.z;
+		const FP coeffS = (FP)2 / ((FP)1 + tx * tx + ty * ty + tz * tz);
+		const FP px = ux + (uy * tz - uz * ty), py = uy + (uz * tx - ux * tz), pz = uz + (ux * ty - uy * tx);
+		ux += coeffS * (py * tz - pz * ty);
+		uy += coeffS * (pz * tx - px * tz);
+		uz += coeffS * (px * ty - py * tx);
+
+		ux += eps * E.x; uy += eps * E.y; uz += eps * E.z;
+		move(rx, ry, rz, vx, vy, vz, ux, uy, uz, dt);
+	}
+
+};
+
+
+// J.-L. Vay, Phys. Plasmas 15, 056701 (2008): the full Lorentz force of the old
+// velocity first, then the implicit half step. Keeps E + v x B = 0 drifts exact.
+struct Vay : RelativisticPusher {
+
+	static const char* getName() { return "Vay"; }
+
+	static void push(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		const Vector3& E, const Vector3& B, const FP dt) {
+		const FP eps = ELECTRON_CHARGE * dt / ((FP)2 * ELECTRON_MASS);
+		const FP invLightVelocity = (FP)1.0 / LIGHT_VELOCITY;
+		const FP gamma = getGamma(vx, vy, vz);
+
+		// u' = u + eps (E + v x B / c) + eps E
+		FP ux = gamma * vx + eps * ((FP)2 * E.x + (vy * B.z - vz * B.y) * invLightVelocity);
+		FP uy = gamma * vy + eps * ((FP)2 * E.y + (vz * B.x - vx * B.z) * invLightVelocity);
+		FP uz = gamma * vz + eps * ((FP)2 * E.z + (vx * B.y - vy * B.x) * invLightVelocity);
+
+		const FP tauX = eps * B.x * invLightVelocity, tauY = eps * B.y * invLightVelocity, tauZ = eps * B.z * invLightVelocity;
+		const FP invNewGamma = (FP)1 / getNewGamma(ux, uy, uz, tauX, tauY, tauZ);
+		rotate(ux, uy, uz, tauX * invNewGamma, tauY * invNewGamma, tauZ * invNewGamma);
+
+		move(rx, ry, rz, vx, vy, vz, ux, uy, uz, dt);
+	}
+
+};
+
+
+// A. V. Higuera, J. R. Cary, Phys. Plasmas 24, 052104 (2017): Boris with gamma
+// of the rotation taken from the Vay equation. Keeps both the phase space
+// volume and the E + v x B = 0 drifts.
+struct HigueraCary : RelativisticPusher {
+
+	static const char* getName() { return "Higuera-Cary"; }
+
+	static void push(FP& rx, FP& ry, FP& rz, FP& vx, FP& vy, FP& vz,
+		const Vector3& E, const Vector3& B, const FP dt) {
+		const FP eps = ELECTRON_CHARGE * dt / ((FP)2 * ELECTRON_MASS);
+		const FP invLightVelocity = (FP)1.0 / LIGHT_VELOCITY;
+		const FP gamma = getGamma(vx, vy, vz);
+		FP ux = gamma * vx + eps * E.x, uy = gamma * vy + eps * E.y, uz = gamma * vz + eps * E.z;
+
+		const FP tauX = eps * B.x * invLightVelocity, tauY = eps * B.y * invLightVelocity, tauZ = eps * B.z * invLightVelocity;
+		const FP invNewGamma = (FP)1 / getNewGamma(ux, uy, uz, tauX, tauY, tauZ);
+		const FP tx = tauX * invNewGamma, ty = tauY * invNewGamma, tz = tauZ * invNewGamma;
+		rotate(ux, uy, uz, tx, ty, tz);
+
+		// u = u+ + eps E + u+ x t
+		const FP x = ux + eps * E.x + (uy * tz - uz * ty);
+		const FP y = uy + eps * E.y + (uz * tx - ux * tz);
+		const FP z = uz + eps * E.z + (ux * ty - uy * tx);
+
+		move(rx, ry, rz, vx, vy, vz, x, y, z, dt);
+	}
+
+};
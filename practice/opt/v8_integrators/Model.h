@@ -0,0 +1,81 @@
+#pragma once
+#include "../Particle.h"
+
+
+// the ensemble of this version, layouts are in ../Particle.h
+using Ensemble = ParticleEnsemble<SoA>;
+#include "Integrators.h"
+
+
+#if defined(__CHUNK_SIZE_16__)
+	#define CHUNK_SIZE 16
+#elif defined(__CHUNK_SIZE_32__)
+	#define CHUNK_SIZE 32
+#elif defined(__CHUNK_SIZE_64__)
+	#define CHUNK_SIZE 64
+#else
+	#define CHUNK_SIZE 32
+#endif
+
+
+// Integrator is one of Integrators.h
+template <class Integrator>
+class Model {
+
+	const Vector3 E, B;  // constant electromagnetic field
+	Ensemble particles;
+
+public:
+
+	Model(const Vector3& E, const Vector3& B,
+		const std::vector<Particle>& particles) :
+		E(E), B(B), particles(particles) {}
+
+	const Ensemble& getParticles() { return particles; }
+
+	static const char* getIntegratorName() { return Integrator::getName(); }
+
+	// one loop over the SoA arrays
+__declspec(noinline) void update(const FP& dt) {
+		const int nParticles = particles.getSize();
+		const Vector3 E = this->E, B = this->B;
+
+		FP* rxPtr = particles.getRxPtr(), * ryPtr = particles.getRyPtr(), * rzPtr = particles.getRzPtr();
+		FP* vxPtr = particles.getVxPtr(), * vyPtr = particles.getVyPtr(), * vzPtr = particles.getVzPtr();
+
+#ifdef __NOVECTOR__
+#pragma novector
+#else
+#pragma omp simd
+#endif
+		for (int i = 0; i < nParticles; i++)
+			Integrator::push(rxPtr[i], ryPtr[i], rzPtr[i], vxPtr[i], vyPtr[i], vzPtr[i], E, B, dt);
+	}
+
+	// the same over chunks of CHUNK_SIZE particles, as in v6_chunks
+__declspec(noinline) void updateChunks(const FP& dt) {
+		const int nParticles = particles.getSize();
+		const int chunkSize = CHUNK_SIZE;
+		const int nChunks = nParticles / chunkSize;  // we consider that nParticles % chunkSize == 0
+		const Vector3 E = this->E, B = this->B;
+
+		for (int chunk = 0; chunk < nChunks; chunk++) {
+
+			FP* rxPtr = particles.getRxPtr() + chunk * chunkSize,
+				* ryPtr = particles.getRyPtr() + chunk * chunkSize,
+				* rzPtr = particles.getRzPtr() + chunk * chunkSize;
+			FP* vxPtr = particles.getVxPtr() + chunk * chunkSize,
+				* vyPtr = particles.getVyPtr() + chunk * chunkSize,
+				* vzPtr = particles.getVzPtr() + chunk * chunkSize;
+
+#ifdef __NOVECTOR__
+#pragma novector
+#else
+#pragma omp simd
+#endif
+			for (int i = 0; i < chunkSize; i++)
+				Integrator::push(rxPtr[i], ryPtr[i], rzPtr[i], vxPtr[i], vyPtr[i], vzPtr[i], E, B, dt);
+		}
+	}
+
+};
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+
+#include "Model.h"
+
+
+const FP E0 = -0.005;
+const FP B0 = 1.0;
+const Vector3 E(0, E0, 0);
+const Vector3 B(0, 0, B0);
+
+const FP V0 = 1e-2 * LIGHT_VELOCITY;
+const Vector3 V(V0, 0, 0);
+const Vector3 R(0, 0, 0);
+
+int PARTICLE_NUMBER = 1048576;  // 2^20
+
+const FP TIME_STEP = 1e-10;
+const int ITERATION_NUMBER = 256;
+
+
+std::pair<Vector3, Vector3> getAnalyticalSolution(FP time) {
+    FP omega = ELECTRON_CHARGE * B0 / (ELECTRON_MASS * LIGHT_VELOCITY);
+    FP b = -E0 / B0 * LIGHT_VELOCITY;
+    FP a = V0 + b;
+    return std::make_pair(
+        Vector3(  // analytical r
+            a / omega * sin(omega * time) - b * time,
+            a / omega * (cos(omega * time) - 1),
+            0.0
+        ),
+        Vector3(  // analytical v
+            a * cos(omega * time) - b,
+            -a * sin(omega * time),
+            0.0
+        )
+    );
+}
+
+
+// r is compared at timeR and v at timeV, they differ for the staggered integrators
+bool checkResult(const Ensemble& particles, FP timeR, FP timeV) {
+    FP eps = 1e-4*LIGHT_VELOCITY;
+    Vector3 analyticalR = getAnalyticalSolution(timeR).first, analyticalV = getAnalyticalSolution(timeV).second;
+    for (int i = 0; i < particles.getSize(); i++) {
+        if ((analyticalR - particles.getR(i)).getNorm() > eps ||  // r
+            (analyticalV - particles.getV(i)).getNorm() > eps)   // v
+            return false;
+    }
+    return true;
+}
+
+
+// errors of r and v against the analytical solution, relative to the radius and
+// the velocity amplitude of the orbit
+std::pair<FP, FP> getError(const Ensemble& particles, FP timeR, FP timeV) {
+    FP omega = ELECTRON_CHARGE * B0 / (ELECTRON_MASS * LIGHT_VELOCITY);
+    FP a = V0 - E0 / B0 * LIGHT_VELOCITY;
+    Vector3 analyticalR = getAnalyticalSolution(timeR).first, analyticalV = getAnalyticalSolution(timeV).second;
+    FP errorR = 0, errorV = 0;
+    for (int i = 0; i < particles.getSize(); i++) {
+        errorR = std::max(errorR, (analyticalR - particles.getR(i)).getNorm());
+        errorV = std::max(errorV, (analyticalV - particles.getV(i)).getNorm());
+    }
+    return std::make_pair(errorR / std::fabs(a / omega), errorV / a);
+}
+
+
+// The leapfrog integrators start from v(-dt/2) and end with v half a step
+// behind r, so both are compared with the analytical solution at their times.
+template <class Integrator>
+void run(bool chunks) {
+    const FP timeV0 = Integrator::isStaggered() ? -(FP)0.5 * TIME_STEP : (FP)0;
+    const Particle particle(R, getAnalyticalSolution(timeV0).second);
+    Model<Integrator> model(E, B, std::vector<Particle>(PARTICLE_NUMBER, particle));
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < ITERATION_NUMBER; iter++)
+        if (chunks)
+            model.updateChunks(TIME_STEP);
+        else
+            model.update(TIME_STEP);
+    auto t1 = std::chrono::steady_clock::now();
+    FP time = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+
+    const FP timeR = ITERATION_NUMBER * TIME_STEP, timeV = timeR + timeV0;
+    std::cout << Model<Integrator>::getIntegratorName() << (chunks ? " (chunks)" : " (SoA)") << ": ";
+    if (!checkResult(model.getParticles(), timeR, timeV)) {
+        std::cout << "ERROR: WRONG RESULT!!!" << std::endl;
+        return;
+    }
+    std::pair<FP, FP> error = getError(model.getParticles(), timeR, timeV);
+    std::cout << "CORRECT RESULT, ERROR OF R IS " << error.first << ", ERROR OF V IS " << error.second <<
+        ", TIME IS " << time << " ms" << std::endl;
+}
+
+
+int main()
+{
+    // the analytical solution is non-relativistic, the relativistic pushers lag
+    // behind it by about (gamma - 1) of the phase
+    FP omega = ELECTRON_CHARGE * B0 / (ELECTRON_MASS * LIGHT_VELOCITY);
+    FP gamma = (FP)1 / std::sqrt((FP)1 - (V0 / LIGHT_VELOCITY) * (V0 / LIGHT_VELOCITY));
+    std::cout << "Relativistic correction is about " << (gamma - 1) * std::fabs(omega) * ITERATION_NUMBER * TIME_STEP <<
+        " of the orbit" << std::endl;
+
+    for (int chunks = 0; chunks < 2; chunks++) {
+        run<Rk4>(chunks);
+        run<BorisNonRelativistic>(chunks);
+        run<Boris>(chunks);
+        run<Vay>(chunks);
+        run<HigueraCary>(chunks);
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <omp.h>
+#include "Vector3.h"
+
+
+#if defined(__CHUNK_SIZE_16__)
+	#define CHUNK_SIZE 16
+#elif defined(__CHUNK_SIZE_32__)
+	#define CHUNK_SIZE 32
+#elif defined(__CHUNK_SIZE_64__)
+	#define CHUNK_SIZE 64
+#else
+	#define CHUNK_SIZE 32
+#endif
+
+
+struct Particle {
+
+	Vector3 r, v;
+
+	Particle() {}
+	Particle(Vector3 r, Vector3 v) :r(r), v(v) {}
+
+};
+
+
+class ParticleEnsemble {
+
+	// SoA (Structure of Arrays)
+	// The arrays are not initialized by new, so a page goes to the NUMA node of the
+	// thread that writes it first. The constructor writes them with the same
+	// static schedule over chunks as Model::update, and both loops pin their
+	// threads with proc_bind(spread), so thread k runs on the same place in both
+	// and updates particles in its local memory. The places are the cores when
+	// OMP_PLACES=cores is set, otherwise the runtime chooses them.
+	FP* rx, * ry, * rz;
+	FP* vx, * vy, * vz;
+	int size;
+
+public:
+
+	// size copies of the particle, we consider that size % CHUNK_SIZE == 0
+	ParticleEnsemble(int size, const Particle& particle) :
+		rx(new FP[size]), ry(new FP[size]), rz(new FP[size]),
+		vx(new FP[size]), vy(new FP[size]), vz(new FP[size]), size(size)
+	{
+		const int nChunks = size / CHUNK_SIZE;
+#pragma omp parallel for schedule(static) proc_bind(spread)
+		for (int chunk = 0; chunk < nChunks; chunk++)
+			for (int i = chunk * CHUNK_SIZE; i < (chunk + 1) * CHUNK_SIZE; i++) {
+				rx[i] = particle.r.x;
+				ry[i] = particle.r.y;
+				rz[i] = particle.r.z;
+
+				vx[i] = particle.v.x;
+				vy[i] = particle.v.y;
+				vz[i] = particle.v.z;
+			}
+	}
+
+	~ParticleEnsemble() {
+		delete[] rx; delete[] ry; delete[] rz;
+		delete[] vx; delete[] vy; delete[] vz;
+	}
+
+	ParticleEnsemble(const ParticleEnsemble&) = delete;
+	ParticleEnsemble& operator=(const ParticleEnsemble&) = delete;
+
+	FP* getRxPtr() { return rx; }
+	FP* getRyPtr() { return ry; }
+	FP* getRzPtr() { return rz; }
+
+	FP* getVxPtr() { return vx; }
+	FP* getVyPtr() { return vy; }
+	FP* getVzPtr() { return vz; }
+
+	// read access
+	Vector3 getR(int index) const { return Vector3(rx[index], ry[index], rz[index]); }
+	Vector3 getV(int index) const { return Vector3(vx[index], vy[index], vz[index]); }
+
+	Particle getParticle(int index) const {
+		return Particle(
+			Vector3(rx[index], ry[index], rz[index]),
+			Vector3(vx[index], vy[index], vz[index])
+		);
+	}
+
+	int getSize() const { return size; }
+
+};
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <utility>
+#include <string>
+#include <algorithm>
+#include <omp.h>
+
+#include "Model.h"
+
+
+const FP E0 = -0.005;
+const FP B0 = 1.0;
+const Vector3 E(0, E0, 0);
+const Vector3 B(0, 0, B0);
+
+const FP V0 = 1e-2 * LIGHT_VELOCITY;
+const Vector3 V(V0, 0, 0);
+const Vector3 R(0, 0, 0);
+
+int MIN_PARTICLE_NUMBER_LOG = 20;  // 2^20
+int MAX_PARTICLE_NUMBER_LOG = 28;  // 2^28, 12 GB
+
+const FP TIME_STEP = 1e-10;
+const int ITERATION_NUMBER = 256;  // for 2^20 particles, the same work for larger numbers
+
+
+std::pair<Vector3, Vector3> getAnalyticalSolution(FP time) {
+    FP omega = ELECTRON_CHARGE * B0 / (ELECTRON_MASS * LIGHT_VELOCITY);
+    FP b = -E0 / B0 * LIGHT_VELOCITY;
+    FP a = V0 + b;
+    return std::make_pair(
+        Vector3(  // analytical r
+            a / omega * sin(omega * time) - b * time,
+            a / omega * (cos(omega * time) - 1),
+            0.0
+        ),
+        Vector3(  // analytical v
+            a * cos(omega * time) - b,
+            -a * sin(omega * time),
+            0.0
+        )
+    );
+}
+
+
+bool checkResult(const ParticleEnsemble& particles, FP time) {
+    FP eps = 1e-4*LIGHT_VELOCITY;
+    std::pair<Vector3, Vector3> analyticalSolution = getAnalyticalSolution(time);
+    for (int i = 0; i < particles.getSize(); i++) {
+		if ((analyticalSolution.first - particles.getR(i)).getNorm() > eps ||  // r
+            (analyticalSolution.second - particles.getV(i)).getNorm() > eps)   // v
+            return false;
+    }
+    return true;
+}
+
+
+// 1, 2, 4, ... and all threads
+std::vector<int> getThreadNumbers() {
+    std::vector<int> threadNumbers;
+    const int maxThreads = omp_get_max_threads();
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadNumbers.push_back(threads);
+    threadNumbers.push_back(maxThreads);
+    return threadNumbers;
+}
+
+
+// ms of the run or -1 if the result is wrong
+FP run(int particleNumber, int iterationNumber, bool chunks) {
+    Model model(E, B, particleNumber, Particle(R, V));  // first touch by the threads of update
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < iterationNumber; iter++)
+        if (chunks)
+            model.updateChunks(TIME_STEP);
+        else
+            model.update(TIME_STEP);
+    auto t1 = std::chrono::steady_clock::now();
+
+    if (!checkResult(model.getParticles(), iterationNumber * TIME_STEP))
+        return -1;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+}
+
+
+// test [min log2 of particles] [max log2 of particles]
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        MIN_PARTICLE_NUMBER_LOG = std::stoi(argv[1]);
+    if (argc > 2)
+        MAX_PARTICLE_NUMBER_LOG = std::stoi(argv[2]);
+    const std::vector<int> threadNumbers = getThreadNumbers();
+    const int maxThreads = omp_get_max_threads();
+
+    for (int log = MIN_PARTICLE_NUMBER_LOG; log <= MAX_PARTICLE_NUMBER_LOG; log++) {
+        const int particleNumber = 1 << log;
+        const int iterationNumber = std::max(1, ITERATION_NUMBER >> std::max(0, log - 20));
+        for (int chunks = 0; chunks < 2; chunks++) {
+            std::cout << "PARTICLES 2^" << log << ", ITERATIONS " << iterationNumber <<
+                (chunks ? ", CHUNKS" : ", SOA") << std::endl;
+            FP serialTime = 0;
+            for (int threads : threadNumbers) {
+                omp_set_num_threads(threads);
+                FP time = run(particleNumber, iterationNumber, chunks);
+                if (time < 0) {
+                    std::cout << "ERROR: WRONG RESULT!!!" << std::endl;
+                    return 1;
+                }
+                if (threads == 1)
+                    serialTime = time;
+                std::cout << "    THREADS " << threads << ": TIME IS " << time << " ms, SPEEDUP " <<
+                    serialTime / std::max(time, (FP)1) << ", " <<
+                    (FP)particleNumber * iterationNumber / std::max(time, (FP)1) / 1e3 << " M UPDATES/S" << std::endl;
+            }
+        }
+    }
+    omp_set_num_threads(maxThreads);
+    std::cout << "CORRECT RESULT" << std::endl;
+
+    return 0;
+}
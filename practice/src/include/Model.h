@@ -1,5 +1,6 @@
 #pragma once
 #include "Particle.h"
+#include "trace.h"
 
 
 // some physical constants
@@ -22,6 +23,7 @@ public:
 	const ParticleEnsemble& getParticles() { return particles; }
 
 	void update(const FP& dt) {  // dt is the time step
+		TRACE_SCOPE("update");
 
 		const FP coeffR = dt / (FP)6;
 		const FP coeffV = coeffR / ELECTRON_MASS;
@@ -2,8 +2,12 @@
 #include <cmath>
 #include <chrono>
 #include <utility>
+#include <vector>
 
 #include "Model.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "result_store.h"
 
 
 const FP E0 = -0.005;
@@ -41,6 +45,7 @@ std::pair<Vector3, Vector3> getAnalyticalSolution(FP time) {
 
 
 bool checkResult(const ParticleEnsemble& particles, FP time) {
+    TRACE_SCOPE("checkResult");
     FP eps = 1e-4*LIGHT_VELOCITY;
     for (int i = 0; i < particles.getSize(); i++) {
         std::pair<Vector3, Vector3> analyticalSolution = getAnalyticalSolution(time);
@@ -60,10 +65,17 @@ int main()
 
     Model model(E, B, particles);
 
+    std::vector<double> samples(ITERATION_NUMBER);  // seconds of every update
+    PerfCounters counters;
+    counters.start();
     auto t0 = std::chrono::steady_clock::now();
-    for (int iter = 0; iter < ITERATION_NUMBER; iter++)
+    for (int iter = 0; iter < ITERATION_NUMBER; iter++) {
+        auto start = std::chrono::steady_clock::now();
         model.update(TIME_STEP);
+        samples[iter] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
     auto t1 = std::chrono::steady_clock::now();
+    counters.stop();
     FP time = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
 
     auto particle = model.getParticles().getParticle(0);
@@ -75,7 +87,12 @@ int main()
     else {
         std::cout << "CORRECT RESULT" << std::endl;
       std::cout << "TIME IS " << time << " ms" << std::endl;
+        saveResult("simple_particle_pusher", "update", samples);
     }
+    std::cout << "PER PARTICLE UPDATE: ";
+    counters.print(std::cout, (double)PARTICLE_NUMBER * ITERATION_NUMBER);
+
+    TRACE_SAVE("test_trace.json");
 
     return 0;
 }